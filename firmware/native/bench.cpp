@@ -0,0 +1,162 @@
+/**
+ * @file bench.cpp
+ * @author James Bennion-Pedley
+ * @brief Per-pattern frame cost benchmark
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <Arduino.h>
+
+#include <algorithm>
+#include <chrono>
+
+#include "kernels.h"
+#include "leds.h"
+#include "native.h"
+#include "patterns.h"
+#include "transition.h"
+
+/*---------------------------- Macros & Constants ----------------------------*/
+
+#define BENCH_FRAME_MS 20 // Virtual time between frames, matches loop()
+#define BENCH_WARMUP 50
+#define BENCH_FADE_MS 1000 // Fade time is held at 0, so every frame is mid-fade
+
+static uint8_t m_colours[3] = {6, 15, 141};
+
+static const uint16_t m_default_lengths[] = {15, 60, 150, 300, 600, 1200, 2400};
+
+/*------------------------------ Private Functions ---------------------------*/
+
+static std::vector<uint16_t> parse_lengths(const char *str)
+{
+    std::vector<uint16_t> lengths;
+
+    while (*str)
+    {
+        char *end;
+        long n = strtol(str, &end, 10);
+        if (end == str)
+            break;
+        if (n > 0)
+            lengths.push_back(n);
+        str = (*end == ',') ? end + 1 : end;
+    }
+
+    return lengths;
+}
+
+/*------------------------------- Public Functions ---------------------------*/
+
+bool bench_parse_options(bench_options_t &opts, int argc, char **argv)
+{
+    opts.frames = 1000;
+    opts.csv = false;
+    opts.lengths.assign(std::begin(m_default_lengths), std::end(m_default_lengths));
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--frames") && i + 1 < argc)
+            opts.frames = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--leds") && i + 1 < argc)
+            opts.lengths = parse_lengths(argv[++i]);
+        else if (!strcmp(argv[i], "--csv"))
+            opts.csv = true;
+        else
+            return false;
+    }
+
+    if (opts.frames < 1)
+        opts.frames = 1;
+
+    if (opts.csv)
+        printf("name,leds,frames,min_us,median_us,p99_us\n");
+    else
+        printf("%-20s %6s %10s %10s %10s\n", "name", "leds", "min us", "median us", "p99 us");
+
+    return true;
+}
+
+void bench_measure(const bench_options_t &opts, const char *name, uint16_t n, const std::function<void(void)> &fn)
+{
+    std::vector<double> samples(opts.frames);
+
+    native_clock_set(0);
+
+    for (int i = 0; i < BENCH_WARMUP + opts.frames; i++)
+    {
+        native_clock_advance(BENCH_FRAME_MS);
+
+        auto t0 = std::chrono::steady_clock::now();
+        fn();
+        auto t1 = std::chrono::steady_clock::now();
+
+        if (i >= BENCH_WARMUP)
+            samples[i - BENCH_WARMUP] = std::chrono::duration<double, std::micro>(t1 - t0).count();
+    }
+
+    std::sort(samples.begin(), samples.end());
+    double min = samples[0];
+    double median = samples[opts.frames / 2];
+    double p99 = samples[std::min(opts.frames - 1, (opts.frames * 99) / 100)];
+
+    if (opts.csv)
+        printf("%s,%u,%d,%.3f,%.3f,%.3f\n", name, n, opts.frames, min, median, p99);
+    else
+        printf("%-20s %6u %10.2f %10.2f %10.2f\n", name, n, min, median, p99);
+}
+
+int bench_main(int argc, char **argv)
+{
+    bench_options_t opts;
+    if (!bench_parse_options(opts, argc, argv))
+        return 1;
+
+    leds_config_t cfg;
+    leds_default_config(&cfg);
+    leds_initialise(&cfg);
+
+    for (uint16_t n : opts.lengths)
+    {
+        cfg.strips[0].length = n;
+        leds_configure(&cfg);
+
+        for (int id = 0; id < PATTERN_COUNT; id++)
+        {
+            bench_measure(opts, patterns_get((pattern_id_t)id)->name, n,
+                          [id]() {
+                              leds_frame_t frame = {millis(), 0, m_colours};
+                              patterns_render((pattern_id_t)id, &frame);
+                          });
+        }
+
+        // Worst crossfade: the two most expensive patterns plus the blend
+        transition_set_duration(0);
+        leds_frame_t outgoing = {millis(), 0, m_colours};
+        transition_render(PATTERN_CALMING, &outgoing, millis());
+        transition_set_duration(BENCH_FADE_MS);
+        bench_measure(opts, "fade Calming>Rainbow", n,
+                      []() {
+                          leds_frame_t frame = {millis(), 0, m_colours};
+                          transition_render(PATTERN_RAINBOW, &frame, 0);
+                      });
+
+        static uint8_t a[NUM_LEDS * 3] __attribute__((aligned(4)));
+        static uint8_t b[NUM_LEDS * 3] __attribute__((aligned(4)));
+        bench_measure(opts, "blend", n, [n]() { kernels_blend(a, a, b, n * 3, 100); });
+
+        // Cost of deciding an unchanged frame doesn't need sending
+        leds_frame_t frame = {millis(), 0, m_colours};
+        patterns_render(PATTERN_SOLID, &frame);
+        bench_measure(opts, "render (unchanged)", n, []() { leds_render(); });
+    }
+
+    return 0;
+}
+
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,370 @@
+/**
+ * @file fire_bench.cpp
+ * @author James Bennion-Pedley
+ * @brief Fire engine checks against the original Fire, and its cost
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <FastLED.h>
+
+#include <algorithm>
+#include <math.h>
+
+#include "fire.h"
+#include "leds.h"
+#include "native.h"
+#include "patterns.h"
+
+/*---------------------------- Macros & Constants ----------------------------*/
+
+#define FIRE_CHECK_TICKS 600
+#define FIRE_CHECK_SPARK_TICKS 20000
+#define FIRE_CHECK_COLUMNS 8
+#define FIRE_CHECK_ROWS 40
+#define FIRE_MEMORY 255 // As leds.cpp replays
+
+// The original's sparks, 190-254 hot, which fire.cpp gives each span
+#define FIRE_CHECK_SPAN 32
+#define FIRE_CHECK_SPARK_MIN 190
+#define FIRE_CHECK_SPARK_MAX 254
+
+/*----------------------------------- State ----------------------------------*/
+
+static uint8_t m_colours[3] = {6, 15, 141};
+
+static const uint16_t m_check_lengths[] = {3, 4, 15, 300, 1000};
+static const uint16_t m_spark_lengths[] = {15, 300};
+static const uint16_t m_bench_lengths[] = {15, 300, 1000};
+
+/*------------------------------ Private Functions ---------------------------*/
+
+static uint32_t report(const char *what, bool ok)
+{
+    printf("%s %s\n", what, ok ? "OK" : "FAIL");
+    return !ok;
+}
+
+static void random_heat(std::vector<uint8_t> &heat, uint32_t r)
+{
+    for (uint8_t &h : heat)
+    {
+        r = r * 1103515245 + 12345;
+        h = r >> 24;
+    }
+}
+
+// A flame that never sparks, so it can be followed cell for cell
+static void plain_flame(fire_t *f, uint8_t *heat, uint16_t length)
+{
+    fire_strip(f, heat, length);
+    f->sparks = 0;
+}
+
+static uint32_t check_palette(void)
+{
+    uint32_t failures = 0;
+    for (uint16_t t = 0; t < 256; t++)
+    {
+        CRGB c = HeatColor(t / 2);
+        const uint8_t *p = fire_palette.rgb[t];
+        failures += c.r != p[0] || c.g != p[1] || c.b != p[2];
+    }
+
+    printf("palette against HeatColor(heat / 2): %u differ %s\n", failures, failures ? "FAIL" : "OK");
+    return failures;
+}
+
+// Where nothing was meant to change: without sparks, and on flames too short
+// to drift, the engine cools and colours as the original did
+static uint32_t check_original(void)
+{
+    uint32_t failures = 0;
+
+    for (uint16_t n = 1; n <= 2; n++)
+    {
+        std::vector<uint8_t> engine(n), original(n);
+        std::vector<CRGB> leds(n), drawn(n);
+        random_heat(engine, n);
+        original = engine;
+
+        fire_t f;
+        plain_flame(&f, engine.data(), n);
+
+        bool ok = true;
+        for (uint32_t tick = 0; tick < FIRE_CHECK_TICKS && ok; tick++)
+        {
+            fire_tick(&f, tick);
+            reference_pattern_fire(leds.data(), original.data(), n, 0);
+            fire_draw(engine.data(), n, drawn.data(), nullptr);
+            ok = engine == original;
+            for (uint16_t i = 0; i < n; i++)
+                ok = ok && leds[i] == drawn[i];
+        }
+
+        char what[48];
+        snprintf(what, sizeof(what), "against the original, %u cells:", n);
+        failures += report(what, ok);
+    }
+
+    return failures;
+}
+
+// Changed: heat drifts up, with the original's commented-out Step 2 put
+// back. The engine takes a third as 85/256, which rounds down by at most
+// one where the original divided by three
+static uint32_t check_drift(void)
+{
+    uint32_t failures = 0;
+
+    for (uint16_t n : m_check_lengths)
+    {
+        std::vector<uint8_t> engine(n), original(n);
+        std::vector<CRGB> leds(n);
+        bool ok = true;
+
+        for (uint32_t start = 0; start < FIRE_CHECK_TICKS && ok; start++)
+        {
+            random_heat(engine, start * 7919 + n);
+            original = engine;
+
+            fire_t f;
+            plain_flame(&f, engine.data(), n);
+            fire_tick(&f, start);
+            reference_pattern_fire(leds.data(), original.data(), n, 0);
+            reference_fire_drift(original.data(), n);
+
+            for (uint16_t i = 0; i < n; i++)
+                ok = ok && engine[i] <= original[i] && original[i] - engine[i] <= 1;
+        }
+
+        char what[48];
+        snprintf(what, sizeof(what), "drift against Step 2, %u cells:", n);
+        failures += report(what, ok);
+    }
+
+    return failures;
+}
+
+// Changed: the original's chance of a spark comes in every 32 cells, where
+// the original had one a frame anywhere but the top cell, so long strips
+// spark as often per pixel. Counted on cold flames, where sparks are all that
+// shows
+static uint32_t check_sparks(void)
+{
+    uint32_t failures = 0;
+
+    for (uint16_t n : m_spark_lengths)
+    {
+        std::vector<uint8_t> heat(n);
+        std::vector<CRGB> leds(n);
+        uint32_t sparks[2] = {};
+        uint8_t least[2] = {255, 255}, most[2] = {};
+        bool top = false;
+
+        random16_set_seed(n);
+        for (uint32_t tick = 0; tick < FIRE_CHECK_SPARK_TICKS; tick++)
+        {
+            for (int side = 0; side < 2; side++)
+            {
+                std::fill(heat.begin(), heat.end(), 0);
+                if (side == 0)
+                {
+                    fire_t f;
+                    fire_strip(&f, heat.data(), n);
+                    fire_tick(&f, tick * 2654435761UL);
+                }
+                else
+                {
+                    reference_pattern_fire(leds.data(), heat.data(), n, REFERENCE_FIRE_SPARKING);
+                    top = top || heat[n - 1] != 0;
+                }
+
+                for (uint8_t h : heat)
+                {
+                    if (h == 0)
+                        continue;
+                    sparks[side]++;
+                    least[side] = std::min(least[side], h);
+                    most[side] = std::max(most[side], h);
+                }
+            }
+        }
+
+        // Within a tenth of the chance; that's well over ten deviations
+        uint32_t spans = (n + FIRE_CHECK_SPAN - 1) / FIRE_CHECK_SPAN;
+        float rate = (float)sparks[0] / FIRE_CHECK_SPARK_TICKS / spans;
+        float original = (float)sparks[1] / FIRE_CHECK_SPARK_TICKS;
+        bool ok = !top;
+        for (int side = 0; side < 2; side++)
+        {
+            float chance = 256 * ((side == 0) ? rate : original);
+            ok = ok && fabsf(chance - REFERENCE_FIRE_SPARKING) < REFERENCE_FIRE_SPARKING / 10.0f &&
+                 least[side] >= FIRE_CHECK_SPARK_MIN && most[side] <= FIRE_CHECK_SPARK_MAX;
+        }
+
+        char what[128];
+        snprintf(what, sizeof(what),
+                 "sparks on %u cells: %.0f/256 a span of %u, %u to %u (original: %.0f/256 a frame, %u to %u):", n,
+                 rate * 256, FIRE_CHECK_SPAN, least[0], most[0], original * 256, least[1], most[1]);
+        failures += report(what, ok);
+    }
+
+    return failures;
+}
+
+// Grid columns step through the heat by a stride, and burn as the same flame
+// would in consecutive cells
+static uint32_t check_columns(void)
+{
+    const uint16_t cells = FIRE_CHECK_COLUMNS * FIRE_CHECK_ROWS;
+    std::vector<uint8_t> grid(cells);
+    std::vector<std::vector<uint8_t>> flames(FIRE_CHECK_COLUMNS, std::vector<uint8_t>(FIRE_CHECK_ROWS));
+    random_heat(grid, cells);
+
+    // Bottom row last, as on a grid
+    for (uint8_t x = 0; x < FIRE_CHECK_COLUMNS; x++)
+    {
+        for (uint8_t y = 0; y < FIRE_CHECK_ROWS; y++)
+            flames[x][y] = grid[(FIRE_CHECK_ROWS - 1 - y) * FIRE_CHECK_COLUMNS + x];
+    }
+
+    for (uint32_t tick = 0; tick < FIRE_CHECK_TICKS; tick++)
+    {
+        for (uint8_t x = 0; x < FIRE_CHECK_COLUMNS; x++)
+        {
+            uint16_t bottom = (FIRE_CHECK_ROWS - 1) * FIRE_CHECK_COLUMNS + x;
+            fire_t column, flame;
+            fire_column(&column, &grid[bottom], FIRE_CHECK_ROWS, -FIRE_CHECK_COLUMNS);
+            flame = column;
+            flame.heat = flames[x].data();
+            flame.stride = 1;
+            fire_tick(&column, tick * 2654435761UL + x);
+            fire_tick(&flame, tick * 2654435761UL + x);
+        }
+    }
+
+    bool ok = true;
+    for (uint8_t x = 0; x < FIRE_CHECK_COLUMNS; x++)
+    {
+        for (uint8_t y = 0; y < FIRE_CHECK_ROWS; y++)
+            ok = ok && flames[x][y] == grid[(FIRE_CHECK_ROWS - 1 - y) * FIRE_CHECK_COLUMNS + x];
+    }
+
+    char what[48];
+    snprintf(what, sizeof(what), "columns %ux%u:", FIRE_CHECK_COLUMNS, FIRE_CHECK_ROWS);
+    return report(what, ok);
+}
+
+// Lights that join late replay FIRE_MEMORY ticks from cold, which is only
+// right if no heat outlasts them
+static uint32_t check_memory(void)
+{
+    std::vector<uint8_t> heat(1000, 255);
+    fire_t f;
+    fire_strip(&f, heat.data(), heat.size());
+    f.sparks = 0;
+
+    for (uint32_t tick = 0; tick < FIRE_MEMORY; tick++)
+        fire_tick(&f, tick);
+
+    bool ok = std::count(heat.begin(), heat.end(), 0) == (long)heat.size();
+    printf("cold after %u ticks: %s\n", FIRE_MEMORY, ok ? "OK" : "FAIL");
+    return !ok;
+}
+
+// However long the strip, flames reach every part of it. The original is
+// shown for contrast: one spark a frame, and random8() only reaches the first
+// 256 cells, left most of a long strip dark
+static uint32_t check_coverage(void)
+{
+    std::vector<uint8_t> heat(1000, 0), original(1000, 0);
+    std::vector<CRGB> leds(1000);
+    fire_t f;
+    fire_strip(&f, heat.data(), heat.size());
+
+    uint32_t lit[2][4] = {};
+    random16_set_seed(1);
+    for (uint32_t tick = 0; tick < 1000; tick++)
+    {
+        fire_tick(&f, tick * 2654435761UL);
+        reference_pattern_fire(leds.data(), original.data(), original.size(), REFERENCE_FIRE_SPARKING);
+        for (uint16_t i = 0; i < heat.size(); i++)
+        {
+            lit[0][i / 250] += heat[i] > 0;
+            lit[1][i / 250] += original[i] > 0;
+        }
+    }
+
+    uint32_t failures = 0;
+    printf("lit per quarter of 1000:");
+    for (uint32_t l : lit[0])
+    {
+        uint32_t percent = l / (250 * 10); // Of 1000 ticks
+        printf(" %u%%", percent);
+        failures += percent < 25;
+    }
+    printf(" (original:");
+    for (uint32_t l : lit[1])
+        printf(" %u%%", l / (250 * 10));
+    printf(") %s\n", failures ? "FAIL" : "OK");
+    return failures;
+}
+
+/*------------------------------- Public Functions ---------------------------*/
+
+int fire_main(int argc, char **argv)
+{
+    if (check_palette() + check_original() + check_drift() + check_sparks() + check_columns() + check_memory() +
+        check_coverage())
+        return 1;
+
+    bench_options_t opts;
+    if (!bench_parse_options(opts, argc, argv))
+        return 1;
+
+    if (std::none_of(argv, argv + argc, [](const char *a) { return !strcmp(a, "--leds"); }))
+        opts.lengths.assign(std::begin(m_bench_lengths), std::end(m_bench_lengths));
+
+    leds_config_t cfg;
+    leds_default_config(&cfg);
+    leds_initialise(&cfg);
+    patterns_start(PATTERN_FIRE);
+
+    for (uint16_t n : opts.lengths)
+    {
+        std::vector<uint8_t> heat(n);
+        std::vector<CRGB> leds(n);
+        fire_t f;
+        fire_strip(&f, heat.data(), n);
+        uint32_t tick = 0;
+
+        // The original: cooling, one spark chance, then HeatColor() for each
+        // pixel. It does less than the engine, without the drift
+        bench_measure(opts, "original", n,
+                      [&]() { reference_pattern_fire(leds.data(), heat.data(), n, REFERENCE_FIRE_SPARKING); });
+
+        bench_measure(opts, "fire engine", n,
+                      [&]() {
+                          fire_tick(&f, tick++);
+                          fire_draw(heat.data(), n, leds.data(), nullptr);
+                      });
+
+        // The pattern, with the shared clock's ticks and its own heat
+        cfg.strips[0].length = n;
+        leds_configure(&cfg);
+        bench_measure(opts, "Fire", n,
+                      []() {
+                          leds_frame_t frame = {millis(), 0, m_colours};
+                          patterns_render(PATTERN_FIRE, &frame);
+                      });
+    }
+
+    return 0;
+}
+
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,650 @@
+/**
+ * @file fleet.cpp
+ * @author James Bennion-Pedley
+ * @brief Fleet load test: simulated lights and phones against a broker stand-in
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <Arduino.h>
+
+#include <math.h>
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <queue>
+#include <random>
+#include <string>
+
+#include "clock.h"
+#include "commands.h"
+#include "leds.h"
+#include "native.h"
+#include "patterns.h"
+#include "protocol.h"
+#include "scheduler.h"
+#include "transition.h"
+
+/*---------------------------- Macros & Constants ----------------------------*/
+
+#define FLEET_PREFIX "DIET-4073c85645649a02734/"
+
+// Matching main.cpp
+#define FLEET_STATE_HOLDOFF_MS 250
+#define FLEET_HEARTBEAT_MS 30000
+
+#define FLEET_STATE_BYTES 800 // About what compose_json() writes
+#define FLEET_MQTT_OVERHEAD 4 // Fixed header and topic length
+
+#define FLEET_INPUT_HZ 60 // Colour picker events while dragging
+
+/*--------------------------------- Datatypes --------------------------------*/
+
+typedef enum
+{
+    FLEET_COMMAND,
+    FLEET_BEACON,
+    FLEET_STATE,
+    FLEET_HEARTBEAT,
+    FLEET_KIND_COUNT,
+} fleet_kind_t;
+
+// Costs on a light, in virtual time. The defaults are rough ESP8266 figures;
+// a light's metrics snapshot gives real ones
+typedef struct
+{
+    uint32_t loop_us;        // One pass of loop() with nothing to do
+    uint32_t json_us;        // Parsing a JSON command
+    uint32_t binary_us;      // Parsing a binary frame
+    uint32_t render_ns;      // Per LED, per pattern rendered
+    uint32_t blend_ns;       // Per LED, while fading
+    uint32_t show_ns;        // Per LED on the wire (WS2812: 24 bits at 1.25 us)
+    uint32_t latch_us;       // Reset time after each frame
+    uint32_t publish_us;     // Composing and sending the state document
+} fleet_costs_t;
+
+typedef struct
+{
+    uint16_t nodes;
+    uint16_t phones;
+    uint32_t seconds;
+    uint16_t leds;
+    pattern_id_t pattern;
+    uint16_t fade_ms;
+    uint32_t debounce_ms;
+    uint32_t idle_ms;    // Mean gap between drags, per phone
+    uint32_t drag_ms;    // Mean drag length
+    float link_ms;       // Mean one-way network delay, on top of 1 ms
+    uint16_t backlog;    // Messages the broker and socket hold per light
+    uint32_t seed;
+    bool json;
+    bool csv;
+    fleet_costs_t costs;
+} fleet_options_t;
+
+typedef struct
+{
+    uint32_t t_input_us; // Last colour picker event behind a command
+    uint32_t t_sent_us;  // When it was published
+    uint32_t t_us;       // When it reached the broker
+    fleet_kind_t kind;
+    std::string topic;
+    std::vector<uint8_t> payload;
+    unsigned int length; // State documents are only counted, not kept
+} fleet_message_t;
+
+typedef struct
+{
+    uint32_t t_us; // When it reached the light
+    uint32_t message;
+} fleet_delivery_t;
+
+// A beacon on its way to a light
+typedef struct
+{
+    uint32_t t_ms;
+    uint16_t node;
+    uint16_t nonce;
+    int32_t ahead; // Of the light's clock, as clock_sync() would say
+} fleet_arrival_t;
+
+typedef struct
+{
+    std::string filter;
+    int client; // Lights first, then phones
+} fleet_subscription_t;
+
+typedef struct
+{
+    uint32_t publishes;
+    uint64_t deliveries[FLEET_KIND_COUNT];
+    uint64_t bytes;
+    double match_us; // Host time spent matching topics
+} fleet_broker_stats_t;
+
+/*----------------------------------- State ----------------------------------*/
+
+static std::vector<fleet_subscription_t> m_subscriptions;
+static std::vector<fleet_message_t> m_messages;
+static std::vector<std::vector<fleet_delivery_t>> m_inbox; // Per light
+static std::vector<uint32_t> m_last_arrival;               // Per client, keeps TCP order
+static fleet_broker_stats_t m_broker;
+
+/*------------------------------ Private Functions ---------------------------*/
+
+static bool parse_options(fleet_options_t &opts, int argc, char **argv)
+{
+    memset(&opts, 0, sizeof(opts));
+    opts.nodes = 100;
+    opts.phones = 20;
+    opts.seconds = 60;
+    opts.leds = 150;
+    opts.pattern = PATTERN_SOLID;
+    opts.fade_ms = TRANSITION_DEFAULT_MS;
+    opts.debounce_ms = 300;
+    opts.idle_ms = 5000;
+    opts.drag_ms = 2000;
+    opts.link_ms = 3;
+    opts.backlog = 100;
+    opts.seed = 1;
+    opts.costs = {100, 350, 25, 1000, 300, 30000, 50, 2000};
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool more = i + 1 < argc;
+        if (!strcmp(argv[i], "--nodes") && more)
+            opts.nodes = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--phones") && more)
+            opts.phones = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--seconds") && more)
+            opts.seconds = strtoul(argv[++i], nullptr, 10);
+        else if (!strcmp(argv[i], "--leds") && more)
+            opts.leds = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--pattern") && more)
+            opts.pattern = patterns_find(argv[++i]);
+        else if (!strcmp(argv[i], "--fade") && more)
+            opts.fade_ms = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--debounce") && more)
+            opts.debounce_ms = strtoul(argv[++i], nullptr, 10);
+        else if (!strcmp(argv[i], "--idle") && more)
+            opts.idle_ms = strtoul(argv[++i], nullptr, 10);
+        else if (!strcmp(argv[i], "--drag") && more)
+            opts.drag_ms = strtoul(argv[++i], nullptr, 10);
+        else if (!strcmp(argv[i], "--link") && more)
+            opts.link_ms = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--backlog") && more)
+            opts.backlog = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--seed") && more)
+            opts.seed = strtoul(argv[++i], nullptr, 10);
+        else if (!strcmp(argv[i], "--render-ns") && more)
+            opts.costs.render_ns = strtoul(argv[++i], nullptr, 10);
+        else if (!strcmp(argv[i], "--loop-us") && more)
+            opts.costs.loop_us = strtoul(argv[++i], nullptr, 10);
+        else if (!strcmp(argv[i], "--json"))
+            opts.json = true;
+        else if (!strcmp(argv[i], "--csv"))
+            opts.csv = true;
+        else
+            return false;
+    }
+
+    // Streamed frames don't come over MQTT
+    return opts.nodes > 0 && opts.leds > 0 && opts.leds <= NUM_LEDS && opts.seconds > 0 &&
+           opts.pattern != PATTERN_COUNT && opts.pattern != PATTERN_STREAM && opts.backlog > 0 &&
+           opts.costs.loop_us > 0;
+}
+
+// Uniform and exponential draws built on the engine alone, since the
+// standard distributions differ between libraries and runs must repeat
+static double uniform(std::mt19937 &rng)
+{
+    return rng() / 4294967296.0;
+}
+
+static uint32_t link_delay_us(std::mt19937 &rng, float mean_ms)
+{
+    return 1000 + (uint32_t)(-mean_ms * 1000 * log(1.0 - uniform(rng)));
+}
+
+static uint32_t exponential_us(std::mt19937 &rng, uint32_t mean_ms)
+{
+    return (uint32_t)(-(double)mean_ms * 1000 * log(1.0 - uniform(rng)));
+}
+
+static void node_topic(char *dest, const char *subtopic, int node)
+{
+    sprintf(dest, FLEET_PREFIX "%s/%012X", subtopic, node);
+}
+
+static bool topic_matches(const char *filter, const char *topic)
+{
+    while (*filter && *topic)
+    {
+        if (*filter == '#')
+            return true;
+
+        if (*filter == '+')
+        {
+            while (*topic && *topic != '/')
+                topic++;
+            filter++;
+            continue;
+        }
+
+        if (*filter++ != *topic++)
+            return false;
+    }
+
+    return *filter == *topic || !strcmp(filter, "#");
+}
+
+static void subscribe(const char *filter, int client)
+{
+    m_subscriptions.push_back({filter, client});
+}
+
+// The broker stand-in: fans a message out to every matching subscriber.
+// Lights get kept messages in their inbox; everything else is only counted
+static void broker_publish(const fleet_message_t &msg, uint32_t message, uint16_t nodes, std::mt19937 &rng, float link_ms)
+{
+    m_broker.publishes++;
+
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<int> clients;
+    for (const auto &sub : m_subscriptions)
+    {
+        if (topic_matches(sub.filter.c_str(), msg.topic.c_str()))
+            clients.push_back(sub.client);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    m_broker.match_us += std::chrono::duration<double, std::micro>(t1 - t0).count();
+
+    for (int client : clients)
+    {
+        m_broker.deliveries[msg.kind]++;
+        m_broker.bytes += msg.length + msg.topic.size() + FLEET_MQTT_OVERHEAD;
+
+        // One connection per client, so messages arrive in order
+        uint32_t t = std::max(m_last_arrival[client], msg.t_us + link_delay_us(rng, link_ms));
+        m_last_arrival[client] = t;
+        if (client < nodes && message != UINT32_MAX)
+            m_inbox[client].push_back({t, message});
+    }
+}
+
+static void add_message(uint32_t t_input_us, uint32_t t_sent_us, uint32_t t_us, fleet_kind_t kind, const char *topic,
+                        const uint8_t *payload, unsigned int length)
+{
+    m_messages.push_back({t_input_us, t_sent_us, t_us, kind, topic, std::vector<uint8_t>(payload, payload + length), length});
+}
+
+// Lights' own publishes only go to phones, so they aren't kept
+static void publish_from_node(uint32_t t_us, fleet_kind_t kind, const char *topic, unsigned int length,
+                              const fleet_options_t &opts, std::mt19937 &rng)
+{
+    fleet_message_t msg = {t_us, t_us, t_us + link_delay_us(rng, opts.link_ms), kind, topic, {}, length};
+    broker_publish(msg, UINT32_MAX, opts.nodes, rng, opts.link_ms);
+}
+
+// Phones drag the colour picker; the page sends once the debounce has been
+// quiet for its full time, as +page.svelte does
+static void generate_commands(const fleet_options_t &opts, std::mt19937 &rng)
+{
+    uint32_t end_us = opts.seconds * 1000000UL;
+    uint32_t event_us = 1000000UL / FLEET_INPUT_HZ;
+    uint32_t debounce_us = opts.debounce_ms * 1000;
+
+    for (uint16_t phone = 0; phone < opts.phones; phone++)
+    {
+        uint32_t t = exponential_us(rng, opts.idle_ms);
+        while (t < end_us)
+        {
+            uint32_t drag_end = t + exponential_us(rng, opts.drag_ms);
+            for (uint32_t e = t; e <= drag_end && e < end_us; e += event_us)
+            {
+                // Only an event with nothing after it inside the debounce sends
+                bool last = e + event_us > drag_end || e + event_us > end_us;
+                if (!last && event_us <= debounce_us)
+                    continue;
+
+                protocol_command_t cmd;
+                memset(&cmd, 0, sizeof(cmd));
+                cmd.fields = PROTOCOL_HAS_MODE | PROTOCOL_HAS_COLOUR;
+                cmd.mode = opts.pattern;
+                uint32_t rgb = rng();
+                cmd.colour[0] = rgb >> 16;
+                cmd.colour[1] = rgb >> 8;
+                cmd.colour[2] = rgb;
+                cmd.seq = (uint16_t)m_messages.size(); // Commands come first, so this is the index
+
+                char buf[96];
+                unsigned int length;
+                if (opts.json)
+                    length = sprintf(buf, "{\"mode\":\"%s\",\"colour\":\"#%02x%02x%02x\",\"seq\":%u}",
+                                     patterns_get(cmd.mode)->name, cmd.colour[0], cmd.colour[1], cmd.colour[2], cmd.seq);
+                else
+                    length = protocol_encode(PROTOCOL_TYPE_COMMAND, &cmd, (uint8_t *)buf);
+
+                uint32_t t_sent = e + debounce_us;
+                add_message(e, t_sent, t_sent + link_delay_us(rng, opts.link_ms), FLEET_COMMAND, FLEET_PREFIX "command",
+                            (const uint8_t *)buf, length);
+            }
+            t = drag_end + debounce_us + exponential_us(rng, opts.idle_ms);
+        }
+    }
+}
+
+// Lights beacon as clock.cpp decides: every light hears every beacon a
+// link delay after it's sent, and the ones in step keep the rest quiet
+static void generate_beacons(const fleet_options_t &opts, std::mt19937 &rng)
+{
+    uint32_t end_ms = opts.seconds * 1000;
+
+    std::vector<clock_beacon_t> timers(opts.nodes);
+    for (clock_beacon_t &b : timers)
+        clock_beacon_start(&b, 0, rng());
+
+    auto later = [](const fleet_arrival_t &a, const fleet_arrival_t &b) { return a.t_ms > b.t_ms; };
+    std::priority_queue<fleet_arrival_t, std::vector<fleet_arrival_t>, decltype(later)> arrivals(later);
+
+    for (;;)
+    {
+        uint16_t sender = 0;
+        for (uint16_t node = 1; node < opts.nodes; node++)
+        {
+            if (timers[node].t_next < timers[sender].t_next)
+                sender = node;
+        }
+        uint32_t t = timers[sender].t_next;
+
+        // Anything heard first may put the beacon off, or bring another forward
+        if (!arrivals.empty() && arrivals.top().t_ms <= t)
+        {
+            fleet_arrival_t a = arrivals.top();
+            arrivals.pop();
+            clock_beacon_heard(&timers[a.node], a.t_ms, a.ahead, a.nonce);
+            continue;
+        }
+
+        if (t >= end_ms)
+            break;
+        clock_beacon_due(&timers[sender], t);
+
+        protocol_command_t beacon;
+        memset(&beacon, 0, sizeof(beacon));
+        beacon.fields = PROTOCOL_HAS_TIME;
+        beacon.time = t;
+        beacon.seq = timers[sender].nonce;
+
+        uint8_t frame[PROTOCOL_FRAME_SIZE];
+        unsigned int length = protocol_encode(PROTOCOL_TYPE_CLOCK, &beacon, frame);
+        uint32_t t_us = t * 1000;
+        add_message(t_us, t_us, t_us + link_delay_us(rng, opts.link_ms), FLEET_BEACON, FLEET_PREFIX "clock", frame,
+                    length);
+
+        // Clocks here are all in step, so a beacon is only as old as its trip
+        for (uint16_t node = 0; node < opts.nodes; node++)
+        {
+            if (node == sender)
+                continue;
+            uint32_t delay_ms = link_delay_us(rng, opts.link_ms) / 1000;
+            arrivals.push({t + delay_ms, node, beacon.seq, -(int32_t)delay_ms});
+        }
+    }
+}
+
+static double percentile(const std::vector<uint32_t> &sorted, unsigned int pct)
+{
+    if (sorted.empty())
+        return 0;
+    return sorted[std::min(sorted.size() - 1, (sorted.size() * pct) / 100)] / 1000.0;
+}
+
+/*------------------------------- Public Functions ---------------------------*/
+
+int fleet_main(int argc, char **argv)
+{
+    fleet_options_t opts;
+    if (!parse_options(opts, argc, argv))
+        return 1;
+
+    std::mt19937 rng(opts.seed);
+    uint16_t clients = opts.nodes + opts.phones;
+
+    // Subscriptions as main.cpp and mqttClient.ts make them
+    char topic[64];
+    for (uint16_t node = 0; node < opts.nodes; node++)
+    {
+        subscribe(FLEET_PREFIX "command", node);
+        subscribe(FLEET_PREFIX "state", node);
+        subscribe(FLEET_PREFIX "clock", node);
+        node_topic(topic, "command", node);
+        subscribe(topic, node);
+        subscribe(FLEET_PREFIX "program/rainbow", node); // The selected program
+    }
+    for (uint16_t phone = 0; phone < opts.phones; phone++)
+    {
+        subscribe(FLEET_PREFIX "state/+", opts.nodes + phone);
+        subscribe(FLEET_PREFIX "heartbeat/+", opts.nodes + phone);
+        subscribe(FLEET_PREFIX "command", opts.nodes + phone);
+    }
+
+    generate_commands(opts, rng);
+    uint32_t commands = m_messages.size();
+    if (commands > 0xFFFF)
+    {
+        printf("fleet: %u commands won't fit the sequence number, shorten the run\n", commands);
+        return 1;
+    }
+    generate_beacons(opts, rng);
+
+    // Route everything from outside the lights in the order it reaches the broker
+    m_inbox.assign(opts.nodes, {});
+    m_last_arrival.assign(clients, 0);
+    std::vector<uint32_t> order(m_messages.size());
+    for (uint32_t i = 0; i < order.size(); i++)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(),
+                     [](uint32_t a, uint32_t b) { return m_messages[a].t_us < m_messages[b].t_us; });
+    for (uint32_t i : order)
+        broker_publish(m_messages[i], i, opts.nodes, rng, opts.link_ms);
+
+    leds_config_t cfg;
+    leds_default_config(&cfg);
+    leds_initialise(&cfg);
+    cfg.strips[0].length = opts.leds;
+    leds_configure(&cfg);
+
+    // Lights only hear from the broker, never each other, so each runs on
+    // its own through the same modules, in the same order, as loop()
+    std::vector<uint32_t> latency; // Publish to the first frame showing it, us
+    std::vector<uint32_t> input;   // The same, from the last picker event
+    std::vector<uint32_t> first(commands, UINT32_MAX), last(commands, 0);
+    uint64_t backlog_drops = 0, queue_drops = 0, coalesced = 0, skipped = 0;
+    uint32_t end_us = opts.seconds * 1000000UL;
+    const fleet_costs_t &c = opts.costs;
+
+    for (uint16_t node = 0; node < opts.nodes; node++)
+    {
+        protocol_command_t cmd;
+        while (commands_pop(&cmd))
+            ;
+        commands_stats_t queue_start = *commands_get_stats();
+        uint32_t skipped_start = scheduler_get_stats()->skipped;
+
+        // Start from a clean cut to the default look
+        pattern_id_t mode = opts.pattern;
+        uint8_t cols[3] = {6, 15, 141};
+        leds_frame_t frame = {0, 0, cols};
+        transition_set_duration(0);
+        transition_render(mode, &frame, 0);
+        transition_set_duration(opts.fade_ms);
+        uint8_t rate = 0;
+
+        const std::vector<fleet_delivery_t> &inbox = m_inbox[node];
+        size_t next = 0;
+        std::deque<uint32_t> backlog;
+        std::vector<uint16_t> pending; // Applied, waiting for a frame
+        bool dirty = false;
+        uint32_t t_state = 0, t_heartbeat = 0;
+
+        for (uint32_t t = 0; t < end_us;)
+        {
+            uint32_t t_ms = t / 1000;
+            native_clock_set(t_ms);
+            uint32_t cost = c.loop_us;
+
+            // The broker queues what we haven't read yet, up to a point
+            for (; next < inbox.size() && inbox[next].t_us <= t; next++)
+            {
+                if (backlog.size() < opts.backlog)
+                    backlog.push_back(inbox[next].message);
+                else
+                    backlog_drops++;
+            }
+
+            // connection_loop(): the client reads one packet per pass
+            if (!backlog.empty())
+            {
+                // Parsed in a copy, as JSON is parsed in place
+                std::vector<uint8_t> payload = m_messages[backlog.front()].payload;
+                backlog.pop_front();
+
+                cost += (payload[0] == PROTOCOL_MAGIC) ? c.binary_us : c.json_us;
+                if (protocol_parse(payload.data(), payload.size(), &cmd) && cmd.type != PROTOCOL_TYPE_CLOCK)
+                    commands_push(&cmd);
+            }
+
+            // apply_commands()
+            while (commands_pop(&cmd))
+            {
+                if (!(cmd.fields & PROTOCOL_HAS_MODE))
+                    continue;
+                mode = cmd.mode;
+                memcpy(cols, cmd.colour, sizeof(cols));
+                scheduler_invalidate();
+                dirty = true;
+                pending.push_back(cmd.seq);
+            }
+
+            uint8_t fps = patterns_get(mode)->fps;
+            if (transition_active() && fps < TRANSITION_FPS)
+                fps = TRANSITION_FPS;
+            if (fps != rate)
+            {
+                scheduler_set_rate(fps, t);
+                rate = fps;
+            }
+
+            if (scheduler_poll(t))
+            {
+                frame = {t_ms, 0, cols};
+                transition_render(mode, &frame, t_ms);
+                uint32_t layers = transition_active() ? 2 : 1;
+                cost += (layers * c.render_ns + (layers - 1) * c.blend_ns) * opts.leds / 1000;
+
+                uint32_t shown = leds_get_stats()->shown;
+                leds_render();
+                if (leds_get_stats()->shown != shown)
+                    cost += c.show_ns * opts.leds / 1000 + c.latch_us;
+
+                uint32_t t_photon = t + cost;
+                for (uint16_t seq : pending)
+                {
+                    latency.push_back(t_photon - m_messages[seq].t_sent_us);
+                    input.push_back(t_photon - m_messages[seq].t_input_us);
+                    first[seq] = std::min(first[seq], t_photon);
+                    last[seq] = std::max(last[seq], t_photon);
+                }
+                pending.clear();
+            }
+
+            // Retained state, then the heartbeat, both fanned out to phones
+            if (dirty && t_ms - t_state >= FLEET_STATE_HOLDOFF_MS)
+            {
+                cost += c.publish_us;
+                node_topic(topic, "state", node);
+                publish_from_node(t + cost, FLEET_STATE, topic, FLEET_STATE_BYTES, opts, rng);
+                dirty = false;
+                t_state = t_ms;
+            }
+
+            if (t_ms - t_heartbeat >= FLEET_HEARTBEAT_MS)
+            {
+                node_topic(topic, "heartbeat", node);
+                publish_from_node(t + cost, FLEET_HEARTBEAT, topic, PROTOCOL_FRAME_SIZE, opts, rng);
+                t_heartbeat = t_ms;
+            }
+
+            t += cost;
+        }
+
+        const commands_stats_t *queue = commands_get_stats();
+        coalesced += queue->coalesced - queue_start.coalesced;
+        queue_drops += queue->dropped - queue_start.dropped;
+        skipped += scheduler_get_stats()->skipped - skipped_start;
+    }
+
+    // How far apart the room shows the same command
+    std::vector<uint32_t> skew;
+    for (uint32_t i = 0; i < commands; i++)
+    {
+        if (first[i] != UINT32_MAX)
+            skew.push_back(last[i] - first[i]);
+    }
+
+    std::sort(latency.begin(), latency.end());
+    std::sort(input.begin(), input.end());
+    std::sort(skew.begin(), skew.end());
+
+    uint64_t deliveries = 0;
+    for (int k = 0; k < FLEET_KIND_COUNT; k++)
+        deliveries += m_broker.deliveries[k];
+
+    if (opts.csv)
+    {
+        printf("nodes,phones,leds,debounce_ms,format,commands,delivered,applied,coalesced,queue_dropped,"
+               "broker_dropped,latency_p50_ms,latency_p99_ms,latency_max_ms,input_p50_ms,input_p99_ms,skew_p99_ms,deliveries_per_s,"
+               "broker_kbytes_per_s\n");
+        printf("%u,%u,%u,%u,%s,%u,%llu,%zu,%llu,%llu,%llu,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.0f,%.1f\n",
+               opts.nodes, opts.phones, opts.leds, opts.debounce_ms, opts.json ? "json" : "binary", commands,
+               (unsigned long long)m_broker.deliveries[FLEET_COMMAND], latency.size(),
+               (unsigned long long)coalesced, (unsigned long long)queue_drops, (unsigned long long)backlog_drops,
+               percentile(latency, 50), percentile(latency, 99), percentile(latency, 100),
+               percentile(input, 50), percentile(input, 99), percentile(skew, 99),
+               deliveries / (double)opts.seconds, m_broker.bytes / 1024.0 / opts.seconds);
+        return 0;
+    }
+
+    printf("%u lights x %u LEDs (%s), %u phones, %u s, %s commands, debounce %u ms, seed %u\n",
+           opts.nodes, opts.leds, patterns_get(opts.pattern)->name, opts.phones, opts.seconds,
+           opts.json ? "JSON" : "binary", opts.debounce_ms, opts.seed);
+    printf("costs: loop %u us, parse %u/%u us, render %u ns/LED, show %u ns/LED, state %u us\n\n",
+           c.loop_us, c.json_us, c.binary_us, c.render_ns, c.show_ns, c.publish_us);
+
+    printf("broker     %u publishes, %llu deliveries (%.0f/s), %.1f kB/s, %.2f us matching per publish\n",
+           m_broker.publishes, (unsigned long long)deliveries, deliveries / (double)opts.seconds,
+           m_broker.bytes / 1024.0 / opts.seconds, m_broker.match_us / m_broker.publishes);
+    printf("           %llu command, %llu clock, %llu state, %llu heartbeat deliveries\n",
+           (unsigned long long)m_broker.deliveries[FLEET_COMMAND], (unsigned long long)m_broker.deliveries[FLEET_BEACON],
+           (unsigned long long)m_broker.deliveries[FLEET_STATE], (unsigned long long)m_broker.deliveries[FLEET_HEARTBEAT]);
+    printf("commands   %u published, %zu shown, %llu coalesced, %llu dropped by the queue, %llu by the broker\n",
+           commands, latency.size(), (unsigned long long)coalesced, (unsigned long long)queue_drops,
+           (unsigned long long)backlog_drops);
+    printf("latency    publish to frame, ms: p50 %.1f, p90 %.1f, p99 %.1f, max %.1f\n",
+           percentile(latency, 50), percentile(latency, 90), percentile(latency, 99), percentile(latency, 100));
+    printf("           last input to frame, ms: p50 %.1f, p90 %.1f, p99 %.1f, max %.1f\n",
+           percentile(input, 50), percentile(input, 90), percentile(input, 99), percentile(input, 100));
+    printf("skew       first to last light, ms: p50 %.1f, p99 %.1f, max %.1f\n",
+           percentile(skew, 50), percentile(skew, 99), percentile(skew, 100));
+    printf("frames     %llu slots skipped\n", (unsigned long long)skipped);
+
+    return 0;
+}
+
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,242 @@
+/**
+ * @file fuzz.cpp
+ * @author James Bennion-Pedley
+ * @brief Command parser fuzzing and JSON/binary parse cost
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <random>
+
+#include "native.h"
+#include "protocol.h"
+
+/*---------------------------- Macros & Constants ----------------------------*/
+
+#define FUZZ_MAX_PAYLOAD 600 // Slightly past the MQTT buffer, like a bad broker
+
+static const char *m_json_seeds[] = {
+    "{\"mode\":\"Calming\"}",
+    "{\"mode\":\"Solid\",\"colour\":\"#060F8D\"}",
+    "{\"enable\":true,\"lock\":false}",
+    "{\"strips\":[{\"pin\":2,\"length\":300},{\"pin\":4,\"length\":60}]}",
+    "{\"mode\":\"Sparkle\",\"colour\":\"#FF00ff\",\"enable\":false,\"lock\":true,\"seq\":42}",
+    "{\"mode\":\"Fire\",\"seed\":3735928559,\"t\":123456789}",
+};
+
+/*------------------------------ Private Functions ---------------------------*/
+
+static unsigned int mutate(std::mt19937 &rng, uint8_t *buf, unsigned int len)
+{
+    unsigned int edits = 1 + rng() % 8;
+    for (unsigned int e = 0; e < edits; e++)
+    {
+        switch (rng() % 4)
+        {
+        case 0: // Flip a bit
+            if (len)
+                buf[rng() % len] ^= 1 << (rng() % 8);
+            break;
+        case 1: // Overwrite a byte
+            if (len)
+                buf[rng() % len] = rng();
+            break;
+        case 2: // Truncate
+            if (len)
+                len = rng() % len;
+            break;
+        case 3: // Append junk
+            while (len < FUZZ_MAX_PAYLOAD && rng() % 4)
+                buf[len++] = rng();
+            break;
+        }
+    }
+
+    return len;
+}
+
+// Every accepted command has to be something main.cpp can apply blindly
+static bool command_sane(const protocol_command_t *cmd)
+{
+    if ((cmd->fields & PROTOCOL_HAS_MODE) && cmd->mode >= PATTERN_COUNT)
+        return false;
+
+    if ((cmd->fields & PROTOCOL_HAS_STRIPS) && cmd->strips.count > LEDS_MAX_STRIPS)
+        return false;
+
+    if ((cmd->fields & PROTOCOL_HAS_PROGRAM) && !protocol_valid_name(cmd->program))
+        return false;
+
+    if ((cmd->fields & PROTOCOL_HAS_LAYOUT) && !layout_valid(&cmd->layout))
+        return false;
+
+    return true;
+}
+
+static bool check_round_trip(std::mt19937 &rng)
+{
+    protocol_command_t in, out;
+    memset(&in, 0, sizeof(in));
+
+    if (rng() % 2)
+    {
+        in.mode = (pattern_id_t)(rng() % PATTERN_COUNT);
+        in.fields |= PROTOCOL_HAS_MODE;
+    }
+    if (rng() % 2)
+    {
+        in.colour[0] = rng();
+        in.colour[1] = rng();
+        in.colour[2] = rng();
+        in.fields |= PROTOCOL_HAS_COLOUR;
+    }
+    if (rng() % 2)
+    {
+        in.enable = rng() % 2;
+        in.lock = rng() % 2;
+        in.fields |= PROTOCOL_HAS_OVERRIDE;
+    }
+    if (rng() % 2)
+    {
+        in.time = rng();
+        in.fields |= PROTOCOL_HAS_TIME;
+    }
+    if (rng() % 2)
+    {
+        in.seed = rng();
+        in.fields |= PROTOCOL_HAS_SEED;
+    }
+    in.seq = rng();
+
+    uint8_t frame[PROTOCOL_FRAME_SIZE];
+    unsigned int len = protocol_encode(PROTOCOL_TYPE_COMMAND, &in, frame);
+    if (!protocol_parse(frame, len, &out))
+        return in.fields == 0;
+
+    if (!(in.fields & PROTOCOL_HAS_COLOUR))
+        memset(in.colour, 0, sizeof(in.colour));
+
+    return out.fields == in.fields && out.seq == in.seq && out.type == PROTOCOL_TYPE_COMMAND &&
+           (!(in.fields & PROTOCOL_HAS_TIME) || out.time == in.time) &&
+           (!(in.fields & PROTOCOL_HAS_SEED) || out.seed == in.seed) &&
+           (!(in.fields & PROTOCOL_HAS_MODE) || out.mode == in.mode) &&
+           !memcmp(out.colour, in.colour, sizeof(in.colour)) &&
+           (!(in.fields & PROTOCOL_HAS_OVERRIDE) || (out.enable == in.enable && out.lock == in.lock));
+}
+
+/*------------------------------- Public Functions ---------------------------*/
+
+int fuzz_main(int argc, char **argv)
+{
+    unsigned long iterations = 1000000;
+    unsigned long seed = 1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--iterations") && i + 1 < argc)
+            iterations = strtoul(argv[++i], nullptr, 10);
+        else if (!strcmp(argv[i], "--seed") && i + 1 < argc)
+            seed = strtoul(argv[++i], nullptr, 10);
+        else
+            return 1;
+    }
+
+    std::mt19937 rng(seed);
+    static uint8_t buf[FUZZ_MAX_PAYLOAD];
+    unsigned long accepted = 0, insane = 0, round_trip = 0;
+
+    for (unsigned long i = 0; i < iterations; i++)
+    {
+        unsigned int len;
+        protocol_command_t cmd;
+
+        // Mix pure noise with mutations of valid binary and JSON commands
+        switch (i % 3)
+        {
+        case 0:
+            len = rng() % FUZZ_MAX_PAYLOAD;
+            for (unsigned int b = 0; b < len; b++)
+                buf[b] = rng();
+            break;
+        case 1:
+            memset(&cmd, 0, sizeof(cmd));
+            cmd.fields = rng() & (PROTOCOL_HAS_MODE | PROTOCOL_HAS_COLOUR | PROTOCOL_HAS_OVERRIDE |
+                                  PROTOCOL_HAS_TIME | PROTOCOL_HAS_SEED);
+            cmd.mode = (pattern_id_t)(rng() % PATTERN_COUNT);
+            len = mutate(rng, buf, protocol_encode(PROTOCOL_TYPE_COMMAND, &cmd, buf));
+            break;
+        default: {
+            const char *seed_json = m_json_seeds[rng() % (sizeof(m_json_seeds) / sizeof(m_json_seeds[0]))];
+            len = strlen(seed_json);
+            memcpy(buf, seed_json, len);
+            len = mutate(rng, buf, len);
+            break;
+        }
+        }
+
+        // Copy to an exact-size heap buffer so overreads show up under ASan
+        uint8_t *payload = (uint8_t *)malloc(len ? len : 1);
+        memcpy(payload, buf, len);
+        if (protocol_parse(payload, len, &cmd))
+        {
+            accepted++;
+            if (!command_sane(&cmd))
+                insane++;
+        }
+        free(payload);
+
+        if (!check_round_trip(rng))
+            round_trip++;
+    }
+
+    printf("%lu payloads, %lu accepted, %lu out of range, %lu round-trip failures\n",
+           iterations, accepted, insane, round_trip);
+
+    return (insane || round_trip) ? 1 : 0;
+}
+
+int protocol_main(int argc, char **argv)
+{
+    bench_options_t opts;
+    if (!bench_parse_options(opts, argc, argv))
+        return 1;
+
+    static const char json[] = "{\"mode\":\"Sparkle\",\"colour\":\"#060F8D\",\"enable\":true,\"lock\":false}";
+
+    // Same command as the JSON above
+    protocol_command_t cmd;
+    memset(&cmd, 0, sizeof(cmd));
+    cmd.fields = PROTOCOL_HAS_MODE | PROTOCOL_HAS_COLOUR | PROTOCOL_HAS_OVERRIDE;
+    cmd.mode = PATTERN_SPARKLE;
+    cmd.colour[0] = 0x06;
+    cmd.colour[1] = 0x0F;
+    cmd.colour[2] = 0x8D;
+    cmd.enable = true;
+
+    uint8_t frame[PROTOCOL_FRAME_SIZE];
+    protocol_encode(PROTOCOL_TYPE_COMMAND, &cmd, frame);
+
+    // The leds column is the payload size in bytes here
+    // JSON is parsed in place, so each pass starts from a fresh copy as the
+    // MQTT client's buffer would
+    static uint8_t work[sizeof(json)];
+    bench_measure(opts, "parse (JSON)", strlen(json), [&cmd]() {
+        memcpy(work, json, sizeof(json));
+        protocol_parse(work, strlen(json), &cmd);
+    });
+    bench_measure(opts, "parse (binary)", sizeof(frame), [&cmd, &frame]() {
+        protocol_parse(frame, sizeof(frame), &cmd);
+    });
+
+    return 0;
+}
+
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,129 @@
+/**
+ * @file kernel_check.cpp
+ * @author James Bennion-Pedley
+ * @brief Word-at-a-time kernels checked against FastLED, and their cost
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <FastLED.h>
+
+#include "kernels.h"
+#include "native.h"
+
+/*---------------------------- Macros & Constants ----------------------------*/
+
+#define KERNELS_MAX_BYTES (4096 * 3)
+
+/*----------------------------------- State ----------------------------------*/
+
+static uint8_t m_a[KERNELS_MAX_BYTES + 4] __attribute__((aligned(4)));
+static uint8_t m_b[KERNELS_MAX_BYTES + 4] __attribute__((aligned(4)));
+static uint8_t m_out[KERNELS_MAX_BYTES + 4] __attribute__((aligned(4)));
+
+/*------------------------------ Private Functions ---------------------------*/
+
+// Every value against every parameter, aligned and not, with ragged tails
+static uint32_t check_sub_scale(void)
+{
+    uint32_t mismatches = 0;
+
+    for (int offset = 0; offset < 2; offset++)
+    {
+        for (int p = 0; p < 256; p++)
+        {
+            uint8_t *buf = &m_out[offset];
+            for (int i = 0; i < 257; i++)
+                buf[i] = i;
+            kernels_sub(buf, 257, p);
+            for (int i = 0; i < 257; i++)
+                mismatches += buf[i] != qsub8(i, p);
+
+            for (int i = 0; i < 257; i++)
+                buf[i] = i;
+            kernels_scale(buf, 257, p);
+            for (int i = 0; i < 257; i++)
+                mismatches += buf[i] != scale8(i, p);
+        }
+    }
+
+    return mismatches;
+}
+
+// Every pair of bytes against every amount, through nblend() as Rainbow uses it
+static uint32_t check_blend(int offset)
+{
+    uint32_t mismatches = 0;
+
+    for (int a = 0; a < 256; a++)
+    {
+        for (int b = 0; b < 256; b++)
+        {
+            m_a[offset + b] = a;
+            m_b[offset + b] = b;
+        }
+
+        for (int amount = 0; amount < 256; amount++)
+        {
+            kernels_blend(&m_out[offset], &m_a[offset], &m_b[offset], 256, amount);
+            for (int b = 0; b < 256; b += 3)
+            {
+                CRGB expected(a, a, a);
+                nblend(expected, CRGB(b, b, b), amount);
+                mismatches += m_out[offset + b] != expected.r;
+            }
+            for (int b = 0; b < 256; b++)
+                mismatches += m_out[offset + b] != blend8(a, b, amount);
+        }
+    }
+
+    return mismatches;
+}
+
+/*------------------------------- Public Functions ---------------------------*/
+
+int kernels_main(int argc, char **argv)
+{
+    uint32_t mismatches = check_sub_scale() + check_blend(0) + check_blend(1);
+    printf("%s: %u mismatching bytes against FastLED\n\n", mismatches ? "FAIL" : "OK", mismatches);
+    if (mismatches)
+        return 1;
+
+    bench_options_t opts;
+    if (!bench_parse_options(opts, argc, argv))
+        return 1;
+
+    for (uint16_t n : opts.lengths)
+    {
+        if (n * 3 > KERNELS_MAX_BYTES)
+            continue;
+
+        // The loops the patterns used to run, pixel by pixel
+        CRGB *pixels = (CRGB *)m_a, *overlay = (CRGB *)m_b;
+        bench_measure(opts, "subtractFromRGB", n, [n, pixels]() {
+            for (uint16_t i = 0; i < n; i++)
+                pixels[i].subtractFromRGB(4);
+        });
+        bench_measure(opts, "kernels_sub", n, [n]() { kernels_sub(m_a, n * 3, 4); });
+
+        bench_measure(opts, "nscale8", n, [n, pixels]() {
+            for (uint16_t i = 0; i < n; i++)
+                pixels[i].nscale8(200);
+        });
+        bench_measure(opts, "kernels_scale", n, [n]() { kernels_scale(m_a, n * 3, 200); });
+
+        bench_measure(opts, "nblend", n, [n, pixels, overlay]() {
+            for (uint16_t i = 0; i < n; i++)
+                nblend(pixels[i], overlay[i], 64);
+        });
+        bench_measure(opts, "kernels_blend", n, [n]() { kernels_blend(m_a, m_a, m_b, n * 3, 64); });
+    }
+
+    return 0;
+}
+
+/*----------------------------------------------------------------------------*/
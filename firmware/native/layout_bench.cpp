@@ -0,0 +1,163 @@
+/**
+ * @file layout_bench.cpp
+ * @author James Bennion-Pedley
+ * @brief Layout table checks, and 2D patterns against their strip versions
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <Arduino.h>
+
+#include <algorithm>
+
+#include "layout.h"
+#include "leds.h"
+#include "native.h"
+#include "patterns.h"
+
+/*---------------------------- Macros & Constants ----------------------------*/
+
+#define LAYOUT_BENCH_LEDS 256
+
+/*--------------------------------- Datatypes --------------------------------*/
+
+typedef struct
+{
+    const char *name;
+    layout_config_t layout;
+    std::vector<uint16_t> xy; // Expected table, row by row
+} layout_case_t;
+
+/*----------------------------------- State ----------------------------------*/
+
+static uint8_t m_colours[3] = {6, 15, 141};
+
+// Wiring drawn out by hand
+static const layout_case_t m_cases[] = {
+    {"rows", {LAYOUT_MATRIX, 0, 4, 3, {}}, {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11}},
+    {"serpentine", {LAYOUT_MATRIX, LAYOUT_SERPENTINE, 4, 3, {}}, {0, 1, 2, 3, 7, 6, 5, 4, 8, 9, 10, 11}},
+    {"columns", {LAYOUT_MATRIX, LAYOUT_SERPENTINE | LAYOUT_VERTICAL, 4, 3, {}}, {0, 5, 6, 11, 1, 4, 7, 10, 2, 3, 8, 9}},
+    {"bottom right", {LAYOUT_MATRIX, LAYOUT_FLIP_X | LAYOUT_FLIP_Y, 4, 3, {}}, {11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0}},
+    {"rings", {LAYOUT_RINGS, 0, 0, 0, {8, 4, 1}}, {0, 1, 2, 3, 4, 5, 6, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 12, 12, 12, 12, 12, 12}},
+};
+
+// Layouts that must be turned away
+static const layout_config_t m_invalid[] = {
+    {LAYOUT_MATRIX, 0, 0, 4, {}},
+    {LAYOUT_MATRIX, 0, 64, 64, {}},
+    {LAYOUT_MATRIX, 1 << 4, 4, 4, {}},
+    {LAYOUT_RINGS, 0, 0, 0, {}},
+    {LAYOUT_RINGS, 0, 0, 0, {8, 0, 4}},
+    {LAYOUT_RINGS + 1, 0, 0, 0, {}},
+};
+
+/*------------------------------ Private Functions ---------------------------*/
+
+static uint32_t check_tables(void)
+{
+    uint32_t failures = 0;
+    layout_resize(NUM_LEDS);
+
+    for (const auto &c : m_cases)
+    {
+        layout_configure(&c.layout);
+        const layout_grid_t *grid = layout_get_grid();
+        bool ok = grid != nullptr && (size_t)grid->width * grid->height == c.xy.size() &&
+                  std::equal(c.xy.begin(), c.xy.end(), grid->xy);
+        if (!ok)
+        {
+            printf("table %-14s FAIL\n", c.name);
+            failures++;
+        }
+    }
+
+    // Every wiring of a matrix reaches each pixel exactly once
+    for (uint8_t flags = 0; flags <= LAYOUT_FLAGS; flags++)
+    {
+        layout_config_t cfg = {LAYOUT_MATRIX, flags, 5, 4, {}};
+        layout_configure(&cfg);
+        const layout_grid_t *grid = layout_get_grid();
+
+        std::vector<uint8_t> hits(20);
+        for (uint16_t i = 0; i < 20; i++)
+            hits[grid->xy[i] < 20 ? grid->xy[i] : 0]++;
+        if (std::count(hits.begin(), hits.end(), 1) != 20)
+        {
+            printf("table flags %x FAIL: not one cell per pixel\n", flags);
+            failures++;
+        }
+    }
+
+    for (const auto &cfg : m_invalid)
+    {
+        if (layout_valid(&cfg))
+        {
+            printf("table invalid type %u %ux%u FAIL: accepted\n", cfg.type, cfg.width, cfg.height);
+            failures++;
+        }
+    }
+
+    // Strips too short for the layout leave patterns on the strip versions
+    layout_config_t big = {LAYOUT_MATRIX, 0, 16, 16, {}};
+    layout_configure(&big);
+    layout_resize(255);
+    failures += layout_get_grid() != nullptr;
+    layout_resize(256);
+    failures += layout_get_grid() == nullptr;
+
+    printf("layout tables %s\n", failures ? "FAIL" : "OK");
+    return failures;
+}
+
+static void bench_pattern(const bench_options_t &opts, const char *name, pattern_id_t id)
+{
+    patterns_start(id);
+    bench_measure(opts, name, LAYOUT_BENCH_LEDS,
+                  [id]() {
+                      leds_frame_t frame = {millis(), 0, m_colours};
+                      patterns_render(id, &frame);
+                  });
+}
+
+/*------------------------------- Public Functions ---------------------------*/
+
+int layout_main(int argc, char **argv)
+{
+    if (check_tables())
+        return 1;
+
+    bench_options_t opts;
+    if (!bench_parse_options(opts, argc, argv))
+        return 1;
+
+    leds_config_t cfg;
+    leds_default_config(&cfg);
+    leds_initialise(&cfg);
+    cfg.strips[0].length = LAYOUT_BENCH_LEDS;
+    leds_configure(&cfg);
+
+    layout_config_t strip = {};
+    layout_configure(&strip);
+    bench_pattern(opts, "Fire", PATTERN_FIRE);
+    bench_pattern(opts, "Calming", PATTERN_CALMING);
+
+    // Same pixel count either way, so the difference is the 2D work itself
+    layout_config_t square = {LAYOUT_MATRIX, LAYOUT_SERPENTINE, 16, 16, {}};
+    layout_configure(&square);
+    bench_pattern(opts, "Fire 16x16", PATTERN_FIRE);
+    bench_pattern(opts, "Calming 16x16", PATTERN_CALMING);
+
+    layout_config_t wide = {LAYOUT_MATRIX, LAYOUT_SERPENTINE, 32, 8, {}};
+    layout_configure(&wide);
+    bench_pattern(opts, "Fire 32x8", PATTERN_FIRE);
+    bench_pattern(opts, "Calming 32x8", PATTERN_CALMING);
+
+    layout_configure(&strip);
+    return 0;
+}
+
+/*----------------------------------------------------------------------------*/
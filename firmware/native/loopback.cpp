@@ -0,0 +1,201 @@
+/**
+ * @file loopback.cpp
+ * @author James Bennion-Pedley
+ * @brief Loopback loss and latency test for UDP pixel streaming
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <FastLED.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+#include "leds.h"
+#include "native.h"
+#include "patterns.h"
+#include "stream.h"
+
+/*---------------------------- Macros & Constants ----------------------------*/
+
+#define STREAM_PACKET_PIXELS 480 // 1440 bytes of RGB, as most DDP senders use
+#define STREAM_FRAME_MS 20
+#define STREAM_WAIT_US 5000 // Frames not complete by now count as lost
+
+/*------------------------------ Private Functions ---------------------------*/
+
+typedef std::vector<uint8_t> packet_t;
+
+static packet_t make_packet(uint8_t seq, uint32_t frame, uint32_t offset, const uint8_t *data,
+                            uint16_t length, bool push)
+{
+    packet_t p(14 + length);
+    p[0] = 0x40 | 0x10 | (push ? 0x01 : 0x00); // Version 1, timecode, push
+    p[1] = seq;
+    p[2] = 0x0B; // RGB, 8 bits per channel
+    p[3] = 1;    // Default display
+    p[4] = offset >> 24;
+    p[5] = offset >> 16;
+    p[6] = offset >> 8;
+    p[7] = offset;
+    p[8] = length >> 8;
+    p[9] = length;
+    p[10] = frame >> 24;
+    p[11] = frame >> 16;
+    p[12] = frame >> 8;
+    p[13] = frame;
+    memcpy(&p[14], data, length);
+    return p;
+}
+
+static bool wait_for_frame(void)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() - t0 < std::chrono::microseconds(STREAM_WAIT_US))
+    {
+        if (stream_loop(millis()))
+            return true;
+    }
+    return false;
+}
+
+/*------------------------------- Public Functions ---------------------------*/
+
+int stream_main(int argc, char **argv)
+{
+    int frames = 2000;
+    uint16_t n = 300;
+    double loss = 0, reorder = 0;
+    unsigned long seed = 1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--frames") && i + 1 < argc)
+            frames = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--leds") && i + 1 < argc)
+            n = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--loss") && i + 1 < argc)
+            loss = atof(argv[++i]) / 100;
+        else if (!strcmp(argv[i], "--reorder") && i + 1 < argc)
+            reorder = atof(argv[++i]) / 100;
+        else if (!strcmp(argv[i], "--seed") && i + 1 < argc)
+            seed = strtoul(argv[++i], nullptr, 10);
+        else
+            return 1;
+    }
+
+    leds_config_t cfg;
+    leds_default_config(&cfg);
+    cfg.strips[0].length = n;
+    leds_initialise(&cfg);
+    if (leds_get_config()->strips[0].length != n)
+    {
+        printf("%u LEDs doesn't fit the arena\n", n);
+        return 1;
+    }
+
+    stream_enable(true);
+
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in dest = {};
+    dest.sin_family = AF_INET;
+    dest.sin_port = htons(STREAM_PORT);
+    dest.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> chance(0, 1);
+    std::vector<uint8_t> expected(n * 3);
+    std::vector<double> latency;
+    uint32_t intact = 0, torn = 0, lost = 0, sent = 0;
+    uint8_t seq = 0;
+
+    native_clock_set(0);
+    for (int f = 0; f < frames; f++)
+    {
+        native_clock_advance(STREAM_FRAME_MS);
+
+        for (size_t i = 0; i < expected.size(); i++)
+            expected[i] = f * 7 + i;
+
+        std::vector<packet_t> packets;
+        for (uint32_t offset = 0; offset < expected.size(); offset += STREAM_PACKET_PIXELS * 3)
+        {
+            uint16_t length = std::min<size_t>(STREAM_PACKET_PIXELS * 3, expected.size() - offset);
+            bool push = offset + length == expected.size();
+            seq = (seq % 15) + 1;
+            packets.push_back(make_packet(seq, f, offset, &expected[offset], length, push));
+        }
+
+        // Impair the link: drop packets, and swap neighbours so one arrives late
+        std::vector<packet_t> wire;
+        for (size_t i = 0; i < packets.size(); i++)
+        {
+            if (chance(rng) < loss)
+                continue;
+            if (i + 1 < packets.size() && chance(rng) < reorder)
+            {
+                wire.push_back(packets[i + 1]);
+                wire.push_back(packets[i]);
+                i++;
+                continue;
+            }
+            wire.push_back(packets[i]);
+        }
+
+        auto t0 = std::chrono::steady_clock::now();
+        for (const packet_t &p : wire)
+            sent += sendto(fd, p.data(), p.size(), 0, (sockaddr *)&dest, sizeof(dest)) > 0;
+
+        if (!wait_for_frame())
+        {
+            lost++;
+            continue;
+        }
+
+        leds_frame_t frame = {millis(), 0, nullptr};
+        patterns_render(PATTERN_STREAM, &frame);
+        auto t1 = std::chrono::steady_clock::now();
+        latency.push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+
+        // Drain anything left of this frame, so it can't bleed into the next
+        while (stream_loop(millis()))
+            ;
+
+        if (!memcmp(FastLED[0].leds(), expected.data(), expected.size()))
+            intact++;
+        else
+            torn++;
+    }
+
+    close(fd);
+
+    const stream_stats_t *stats = stream_get_stats();
+    printf("%d frames of %u LEDs, %u packets sent, %u received, %u late, %u invalid\n",
+           frames, n, sent, stats->packets, stats->late, stats->invalid);
+    printf("%u intact, %u torn, %u lost\n", intact, torn, lost);
+
+    if (!latency.empty())
+    {
+        std::sort(latency.begin(), latency.end());
+        printf("send to swap: min %.1f us, median %.1f us, p99 %.1f us\n", latency.front(),
+               latency[latency.size() / 2], latency[(latency.size() * 99) / 100]);
+    }
+
+    // A clean link has to deliver every frame exactly
+    if (loss == 0 && reorder == 0 && intact != (uint32_t)frames)
+        return 1;
+
+    return 0;
+}
+
+/*----------------------------------------------------------------------------*/
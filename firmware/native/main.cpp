@@ -0,0 +1,62 @@
+/**
+ * @file main.cpp
+ * @author James Bennion-Pedley
+ * @brief Host-native tooling for the firmware
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "native.h"
+
+/*---------------------------- Macros & Constants ----------------------------*/
+
+typedef int (*command_t)(int argc, char **argv);
+
+static const struct
+{
+    const char *name;
+    command_t fn;
+    const char *help;
+} m_commands[] = {
+    {"audio", audio_main, "beat and band analysis of a synthetic track, then cost [--wav F [--gain G] [--trace]] [--frames N] [--leds ...]"},
+    {"bench", bench_main, "per-pattern frame cost [--frames N] [--leds 15,60,...] [--csv]"},
+    {"calming", calming_main, "check table-driven Calming against the reference, before/after cost"},
+    {"fire", fire_main, "check the fire engine against Fire2012's three passes, then cost [--frames N] [--leds 15,300,1000] [--csv]"},
+    {"fleet", fleet_main, "lights and phones against a broker stand-in, in virtual time [--nodes N] [--phones N] [--debounce MS] [--json] [--csv]"},
+    {"fuzz", fuzz_main, "throw random and mutated payloads at the command parser [--iterations N] [--seed S]"},
+    {"kernels", kernels_main, "check word-at-a-time kernels against FastLED, then cost [--frames N] [--leds ...]"},
+    {"layout", layout_main, "check matrix and ring tables, then 2D Fire and Calming at 16x16 and 32x8 [--frames N] [--csv]"},
+    {"protocol", protocol_main, "JSON vs binary command parse cost [--frames N] [--csv]"},
+    {"sim", sim_main, "run patterns on a virtual clock [--pattern P] [--seconds N] [--leds N] [--ppm F] [--term] [--record DIR] [--compare DIR] [--check [--update]]"},
+    {"stream", stream_main, "UDP streaming over loopback [--frames N] [--leds N] [--loss %] [--reorder %]"},
+    {"vm", vm_main, "check the pattern VM's verifier, then interpreted vs native Rainbow [--frames N] [--leds ...]"},
+};
+
+/*------------------------------- Public Functions ---------------------------*/
+
+int main(int argc, char **argv)
+{
+    if (argc >= 2)
+    {
+        for (const auto &c : m_commands)
+        {
+            if (!strcmp(argv[1], c.name))
+                return c.fn(argc - 1, argv + 1);
+        }
+    }
+
+    printf("Usage: %s <command> [options]\n\n", argv[0]);
+    for (const auto &c : m_commands)
+        printf("  %-10s %s\n", c.name, c.help);
+
+    return 1;
+}
+
+/*----------------------------------------------------------------------------*/
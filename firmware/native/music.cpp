@@ -0,0 +1,343 @@
+/**
+ * @file music.cpp
+ * @author James Bennion-Pedley
+ * @brief Audio analysis fed from WAV files or a synthetic beat, and its cost
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <Arduino.h>
+
+#include <math.h>
+
+#include "audio.h"
+#include "leds.h"
+#include "native.h"
+#include "patterns.h"
+
+/*---------------------------- Macros & Constants ----------------------------*/
+
+// Samples handed over between frames, as the interrupt would at 50 fps
+#define MUSIC_FRAME_MS 20
+#define MUSIC_FRAME_SAMPLES (AUDIO_SAMPLE_HZ * MUSIC_FRAME_MS / 1000)
+
+// Synthetic track: a kick on every beat, a hi-hat between, and a held note
+#define MUSIC_CHECK_BPM 120
+#define MUSIC_CHECK_SECONDS 12
+#define MUSIC_CHECK_TOLERANCE 3 // BPM either way
+#define MUSIC_CHECK_SHOW_MS 10    // show() for 300 pixels, with no sampling
+
+/*--------------------------------- Datatypes --------------------------------*/
+
+typedef struct
+{
+    const char *wav;
+    float gain;
+    bool trace;
+} music_options_t;
+
+/*----------------------------------- State ----------------------------------*/
+
+static uint8_t m_colours[3] = {255, 255, 255};
+
+/*------------------------------ Private Functions ---------------------------*/
+
+// ADC codes: the microphone's bias at mid-scale, clipped to 10 bits
+static uint16_t adc_code(float x)
+{
+    long code = lroundf(512 + x);
+    return (code < 0) ? 0 : (code > 1023) ? 1023 : code;
+}
+
+std::vector<uint16_t> music_synthesise(uint32_t bpm, uint32_t seconds)
+{
+    std::vector<uint16_t> samples(AUDIO_SAMPLE_HZ * seconds);
+    uint32_t period = AUDIO_SAMPLE_HZ * 60 / bpm;
+    uint32_t noise = 1;
+
+    for (uint32_t i = 0; i < samples.size(); i++)
+    {
+        float t_beat = (float)(i % period) / AUDIO_SAMPLE_HZ;
+        float t_off = (float)((i + period / 2) % period) / AUDIO_SAMPLE_HZ;
+        float t = (float)i / AUDIO_SAMPLE_HZ;
+
+        noise = noise * 1103515245 + 12345;
+        float white = (float)((noise >> 16) & 0x7FFF) / 16384.0f - 1.0f;
+
+        float kick = 350.0f * expf(-t_beat / 0.06f) * sinf(2 * (float)M_PI * 60.0f * t_beat);
+        float hat = 80.0f * expf(-t_off / 0.01f) * white;
+        float note = 40.0f * sinf(2 * (float)M_PI * 440.0f * t);
+        samples[i] = adc_code(kick + hat + note);
+    }
+
+    return samples;
+}
+
+// 16-bit PCM, any channel count and any rate from AUDIO_SAMPLE_HZ up; each
+// output sample is the mean of the input it covers
+static bool read_wav(const char *path, float gain, std::vector<uint16_t> &samples)
+{
+    FILE *f = fopen(path, "rb");
+    if (f == nullptr)
+    {
+        printf("%s: can't open\n", path);
+        return false;
+    }
+
+    uint8_t riff[12];
+    uint16_t channels = 0, bits = 0;
+    uint32_t rate = 0;
+    bool ok = fread(riff, 1, sizeof(riff), f) == sizeof(riff) && !memcmp(riff, "RIFF", 4) && !memcmp(&riff[8], "WAVE", 4);
+
+    uint8_t chunk[8];
+    while (ok && fread(chunk, 1, sizeof(chunk), f) == sizeof(chunk))
+    {
+        uint32_t size = chunk[4] | (chunk[5] << 8) | (chunk[6] << 16) | ((uint32_t)chunk[7] << 24);
+
+        if (!memcmp(chunk, "fmt ", 4))
+        {
+            uint8_t fmt[16];
+            ok = size >= sizeof(fmt) && fread(fmt, 1, sizeof(fmt), f) == sizeof(fmt);
+            channels = fmt[2] | (fmt[3] << 8);
+            rate = fmt[4] | (fmt[5] << 8) | (fmt[6] << 16) | ((uint32_t)fmt[7] << 24);
+            bits = fmt[14] | (fmt[15] << 8);
+            ok = ok && (fmt[0] | (fmt[1] << 8)) == 1 && bits == 16 && channels > 0 && rate >= AUDIO_SAMPLE_HZ;
+            fseek(f, size - sizeof(fmt) + (size & 1), SEEK_CUR);
+        }
+        else if (!memcmp(chunk, "data", 4) && channels > 0)
+        {
+            int64_t sum = 0;
+            uint32_t count = 0, phase = 0;
+            std::vector<int16_t> frame(channels);
+
+            for (uint32_t n = size / (2 * channels); n > 0; n--)
+            {
+                if (fread(frame.data(), 2, channels, f) != channels)
+                    break;
+                for (int16_t s : frame)
+                    sum += s;
+                count += channels;
+
+                phase += AUDIO_SAMPLE_HZ;
+                if (phase >= rate)
+                {
+                    phase -= rate;
+                    samples.push_back(adc_code(gain * (float)sum / count / 64.0f));
+                    sum = 0;
+                    count = 0;
+                }
+            }
+            break;
+        }
+        else
+        {
+            fseek(f, size + (size & 1), SEEK_CUR);
+        }
+    }
+
+    fclose(f);
+
+    if (!ok || samples.empty())
+    {
+        printf("%s: not 16-bit PCM at %u Hz or more\n", path, AUDIO_SAMPLE_HZ);
+        return false;
+    }
+    return true;
+}
+
+// Feeds the samples in a frame's worth at a time, as the device would;
+// returns the block each beat was found in
+// The last gap sample times of each frame pass while the strip is shown,
+// and are filled in from the next reading, as the sampler does
+static std::vector<uint32_t> analyse(const std::vector<uint16_t> &samples, bool trace, uint32_t gap = 0)
+{
+    std::vector<uint32_t> beats;
+    audio_reset();
+
+    if (trace)
+        printf("block,ms,bass,low,mid,high,level,centroid,beat\n");
+
+    uint16_t missed = 0;
+    for (uint32_t i = 0; i < samples.size(); i++)
+    {
+        if ((i % MUSIC_FRAME_SAMPLES) >= MUSIC_FRAME_SAMPLES - gap)
+        {
+            missed++;
+        }
+        else
+        {
+            audio_push_late(samples[i], missed + 1);
+            missed = 0;
+        }
+
+        if ((i + 1) % MUSIC_FRAME_SAMPLES != 0)
+            continue;
+
+        // A frame is shorter than a block, so there's at most one to report
+        uint32_t beats_before = audio_get_features()->beats;
+        uint32_t blocks = audio_poll();
+
+        const audio_features_t *a = audio_get_features();
+        if (a->beats != beats_before)
+            beats.push_back(a->blocks - 1);
+
+        if (trace && blocks > 0)
+        {
+            uint32_t block = a->blocks - 1;
+            printf("%u,%u,%u,%u,%u,%u,%u,%u,%u\n", block, block * AUDIO_BLOCK * 1000 / AUDIO_SAMPLE_HZ,
+                   a->bands[0], a->bands[1], a->bands[2], a->bands[3], a->level, a->centroid,
+                   a->beats != beats_before);
+        }
+    }
+
+    return beats;
+}
+
+// From the mean gap between beats, so it isn't limited to whole blocks
+static float beats_per_minute(const std::vector<uint32_t> &beats)
+{
+    if (beats.size() < 2)
+        return 0;
+
+    float blocks = (float)(beats.back() - beats.front()) / (beats.size() - 1);
+    return 60.0f * AUDIO_SAMPLE_HZ / (blocks * AUDIO_BLOCK);
+}
+
+static uint32_t check_analysis(void)
+{
+    uint32_t failures = 0;
+
+    std::vector<uint16_t> track = music_synthesise(MUSIC_CHECK_BPM, MUSIC_CHECK_SECONDS);
+    std::vector<uint32_t> beats = analyse(track, false);
+    float bpm = beats_per_minute(beats);
+    uint32_t expected = MUSIC_CHECK_BPM * MUSIC_CHECK_SECONDS / 60;
+    bool ok = fabsf(bpm - MUSIC_CHECK_BPM) <= MUSIC_CHECK_TOLERANCE && beats.size() + 1 >= expected &&
+              beats.size() <= expected;
+    printf("beat %u BPM: %zu beats at %.1f BPM %s\n", MUSIC_CHECK_BPM, beats.size(), bpm, ok ? "OK" : "FAIL");
+    failures += !ok;
+
+    // The same, sampled only between shows
+    beats = analyse(track, false, AUDIO_SAMPLE_HZ * MUSIC_CHECK_SHOW_MS / 1000);
+    bpm = beats_per_minute(beats);
+    ok = fabsf(bpm - MUSIC_CHECK_BPM) <= MUSIC_CHECK_TOLERANCE && beats.size() + 1 >= expected &&
+         beats.size() <= expected;
+    printf("beat %u BPM, %u ms shows: %zu beats at %.1f BPM %s\n", MUSIC_CHECK_BPM, MUSIC_CHECK_SHOW_MS,
+           beats.size(), bpm, ok ? "OK" : "FAIL");
+    failures += !ok;
+
+    // Silence, and a steady note, are never beats
+    std::vector<uint16_t> silence(AUDIO_SAMPLE_HZ * 4, 512);
+    beats = analyse(silence, false);
+    ok = beats.empty() && audio_get_features()->level == 0;
+    printf("silence: %zu beats, level %u %s\n", beats.size(), audio_get_features()->level, ok ? "OK" : "FAIL");
+    failures += !ok;
+
+    // A 500 Hz tone is bin 16 of 31, halfway up
+    std::vector<uint16_t> tone(AUDIO_SAMPLE_HZ * 4);
+    for (uint32_t i = 0; i < tone.size(); i++)
+        tone[i] = adc_code(300.0f * sinf(2 * (float)M_PI * 500.0f * i / AUDIO_SAMPLE_HZ));
+    beats = analyse(tone, false);
+    uint8_t centroid = audio_get_features()->centroid;
+    ok = beats.empty() && centroid > 112 && centroid < 144;
+    printf("500 Hz tone: %zu beats, centroid %u %s\n", beats.size(), centroid, ok ? "OK" : "FAIL");
+    failures += !ok;
+
+    return failures;
+}
+
+static void parse_options(music_options_t &opts, int argc, char **argv, std::vector<char *> &rest)
+{
+    opts.wav = nullptr;
+    opts.gain = 1.0f;
+    opts.trace = false;
+    rest.push_back(argv[0]);
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool more = i + 1 < argc;
+        if (!strcmp(argv[i], "--wav") && more)
+            opts.wav = argv[++i];
+        else if (!strcmp(argv[i], "--gain") && more)
+            opts.gain = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--trace"))
+            opts.trace = true;
+        else
+            rest.push_back(argv[i]);
+    }
+}
+
+/*------------------------------- Public Functions ---------------------------*/
+
+int audio_main(int argc, char **argv)
+{
+    music_options_t music;
+    std::vector<char *> rest;
+    parse_options(music, argc, argv, rest);
+
+    // A recording is analysed and reported on, nothing else
+    if (music.wav != nullptr)
+    {
+        std::vector<uint16_t> samples;
+        if (!read_wav(music.wav, music.gain, samples))
+            return 1;
+
+        std::vector<uint32_t> beats = analyse(samples, music.trace);
+        if (!music.trace)
+        {
+            for (uint32_t block : beats)
+                printf("beat at %.2f s\n", (float)block * AUDIO_BLOCK / AUDIO_SAMPLE_HZ);
+            printf("%.1f s, %zu beats, %.1f BPM, %u samples lost\n", (float)samples.size() / AUDIO_SAMPLE_HZ,
+                   beats.size(), beats_per_minute(beats), audio_get_features()->overflows);
+        }
+        return 0;
+    }
+
+    if (check_analysis())
+        return 1;
+
+    bench_options_t opts;
+    if (!bench_parse_options(opts, rest.size(), rest.data()))
+        return 1;
+
+    // For the block row, "leds" is samples per block
+    std::vector<uint16_t> track = music_synthesise(MUSIC_CHECK_BPM, MUSIC_CHECK_SECONDS);
+    uint32_t offset = 0;
+    auto next = [&track, &offset]() {
+        const uint16_t *samples = &track[offset];
+        offset = (offset + MUSIC_FRAME_SAMPLES) % (track.size() - AUDIO_BLOCK);
+        return samples;
+    };
+
+    audio_reset();
+    bench_measure(opts, "audio block", AUDIO_BLOCK, [&next]() { audio_analyse(next()); });
+
+    leds_config_t cfg;
+    leds_default_config(&cfg);
+    leds_initialise(&cfg);
+    patterns_start(PATTERN_MUSIC);
+
+    // Frames include the analysis of whatever was sampled since the last
+    for (uint16_t n : opts.lengths)
+    {
+        cfg.strips[0].length = n;
+        leds_configure(&cfg);
+
+        bench_measure(opts, "Music", n,
+                      [&next]() {
+                          const uint16_t *samples = next();
+                          for (int i = 0; i < MUSIC_FRAME_SAMPLES; i++)
+                              audio_push(samples[i]);
+
+                          leds_frame_t frame = {millis(), 0, m_colours};
+                          patterns_render(PATTERN_MUSIC, &frame);
+                      });
+    }
+
+    return 0;
+}
+
+/*----------------------------------------------------------------------------*/
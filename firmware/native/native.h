@@ -0,0 +1,67 @@
+/**
+ * @file native.h
+ * @author James Bennion-Pedley
+ * @brief Host-native tooling entry points
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef __FIRMWARE_NATIVE_NATIVE_H__
+#define __FIRMWARE_NATIVE_NATIVE_H__
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <stdint.h>
+
+#include <functional>
+#include <vector>
+
+/*---------------------------- Macros & Constants ----------------------------*/
+
+#define REFERENCE_FIRE_SPARKING 60 // The original Fire's SPARKING
+
+/*--------------------------------- Datatypes --------------------------------*/
+
+typedef struct
+{
+    int frames;
+    bool csv;
+    std::vector<uint16_t> lengths;
+} bench_options_t;
+
+/*--------------------------------- Functions --------------------------------*/
+
+// Shared by every benchmark: parses --frames/--leds/--csv and prints a header
+bool bench_parse_options(bench_options_t &opts, int argc, char **argv);
+void bench_measure(const bench_options_t &opts, const char *name, uint16_t n, const std::function<void(void)> &fn);
+
+int audio_main(int argc, char **argv);
+int bench_main(int argc, char **argv);
+int calming_main(int argc, char **argv);
+int fire_main(int argc, char **argv);
+int fleet_main(int argc, char **argv);
+int fuzz_main(int argc, char **argv);
+int kernels_main(int argc, char **argv);
+int layout_main(int argc, char **argv);
+int protocol_main(int argc, char **argv);
+int sim_main(int argc, char **argv);
+int stream_main(int argc, char **argv);
+int vm_main(int argc, char **argv);
+
+// Inputs for patterns that need something to draw: the built-in Rainbow as
+// a Custom program, and ADC samples of a track with a kick on every beat
+extern const uint8_t vm_rainbow[];
+extern const unsigned int vm_rainbow_length;
+std::vector<uint16_t> music_synthesise(uint32_t bpm, uint32_t seconds);
+
+// Original pattern implementations, kept to check optimised ones against
+struct CRGB;
+void reference_pattern_calming(CRGB *leds, uint16_t n);
+void reference_pattern_fire(CRGB *leds, uint8_t *heat, uint16_t n, uint8_t sparking);
+void reference_fire_drift(uint8_t *heat, uint16_t n);
+
+/*----------------------------------------------------------------------------*/
+
+#endif /* __FIRMWARE_NATIVE_NATIVE_H__ */
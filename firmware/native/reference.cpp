@@ -0,0 +1,150 @@
+/**
+ * @file reference.cpp
+ * @author James Bennion-Pedley
+ * @brief Reference pattern implementations for checking optimised versions
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * These are the original, straightforward versions of patterns that have since
+ * been optimised in leds.cpp. They render into a caller-supplied buffer so the
+ * two can be run side by side on the same virtual clock.
+ *
+ */
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <FastLED.h>
+
+#include "native.h"
+#include "waves.h"
+
+/*----------------------------------- State ----------------------------------*/
+
+static CRGBPalette16 pacifica_palette_1 =
+    {0x000507, 0x000409, 0x00030B, 0x00030D, 0x000210, 0x000212, 0x000114, 0x000117,
+     0x000019, 0x00001C, 0x000026, 0x000031, 0x00003B, 0x000046, 0x14554B, 0x28AA50};
+static CRGBPalette16 pacifica_palette_2 =
+    {0x000507, 0x000409, 0x00030B, 0x00030D, 0x000210, 0x000212, 0x000114, 0x000117,
+     0x000019, 0x00001C, 0x000026, 0x000031, 0x00003B, 0x000046, 0x0C5F52, 0x19BE5F};
+static CRGBPalette16 pacifica_palette_3 =
+    {0x000208, 0x00030E, 0x000514, 0x00061A, 0x000820, 0x000927, 0x000B2D, 0x000C33,
+     0x000E39, 0x001040, 0x001450, 0x001860, 0x001C70, 0x002080, 0x1040BF, 0x2060FF};
+
+/*------------------------------ Private Functions ---------------------------*/
+
+static void pacifica_one_layer(CRGB *leds, uint16_t n, CRGBPalette16 &p, uint16_t cistart, uint16_t wavescale,
+                               uint8_t bri, uint16_t ioff)
+{
+    uint16_t ci = cistart;
+    uint16_t waveangle = ioff;
+    uint16_t wavescale_half = (wavescale / 2) + 20;
+    for (uint16_t i = 0; i < n; i++)
+    {
+        waveangle += 250;
+        uint16_t s16 = sin16(waveangle) + 32768;
+        uint16_t cs = scale16(s16, wavescale_half) + wavescale_half;
+        ci += cs;
+        uint16_t sindex16 = sin16(ci) + 32768;
+        uint8_t sindex8 = scale16(sindex16, 240);
+        CRGB c = ColorFromPalette(p, sindex8, bri, LINEARBLEND);
+        leds[i] += c;
+    }
+}
+
+static void pacifica_add_whitecaps(CRGB *leds, uint16_t n)
+{
+    uint8_t basethreshold = beatsin8(9, 55, 65);
+    uint8_t wave = beat8(7);
+
+    for (uint16_t i = 0; i < n; i++)
+    {
+        uint8_t threshold = scale8(sin8(wave), 20) + basethreshold;
+        wave += 7;
+        uint8_t l = leds[i].getAverageLight();
+        if (l > threshold)
+        {
+            uint8_t overage = l - threshold;
+            uint8_t overage2 = qadd8(overage, overage);
+            leds[i] += CRGB(overage, overage2, qadd8(overage2, overage2));
+        }
+    }
+}
+
+static void pacifica_deepen_colors(CRGB *leds, uint16_t n)
+{
+    for (uint16_t i = 0; i < n; i++)
+    {
+        leds[i].blue = scale8(leds[i].blue, 145);
+        leds[i].green = scale8(leds[i].green, 200);
+        leds[i] |= CRGB(2, 5, 7);
+    }
+}
+
+/*------------------------------- Public Functions ---------------------------*/
+
+void reference_pattern_calming(CRGB *leds, uint16_t n)
+{
+    // The colour index starts used to be accumulated frame by frame; they
+    // now come from the shared clock, the same way as in leds.cpp
+    const waves_beatsin_t speed1 = {3 << 8, 179, 269}, speed2 = {4 << 8, 179, 269};
+    const waves_beatsin_t rate1 = {1011, 10, 13}, rate2 = {777, 8, 11}, rate3 = {501, 5, 7}, rate4 = {257, 4, 6};
+    uint32_t ms = GET_MILLIS();
+    uint16_t sCIStart1 = waves_product_integral(ms, &speed1, &rate1, 256);
+    uint16_t sCIStart2 = 0 - waves_product_integral(ms, &speed1, &rate2, 512) - waves_product_integral(ms, &speed2, &rate2, 512);
+    uint16_t sCIStart3 = 0 - waves_product_integral(ms, &speed1, &rate3, 256);
+    uint16_t sCIStart4 = 0 - waves_product_integral(ms, &speed2, &rate4, 256);
+
+    fill_solid(leds, n, CRGB(2, 6, 10));
+
+    pacifica_one_layer(leds, n, pacifica_palette_1, sCIStart1, beatsin16(3, 11 * 256, 14 * 256), beatsin8(10, 70, 130), 0 - beat16(301));
+    pacifica_one_layer(leds, n, pacifica_palette_2, sCIStart2, beatsin16(4, 6 * 256, 9 * 256), beatsin8(17, 40, 80), beat16(401));
+    pacifica_one_layer(leds, n, pacifica_palette_3, sCIStart3, 6 * 256, beatsin8(9, 10, 38), 0 - beat16(503));
+    pacifica_one_layer(leds, n, pacifica_palette_3, sCIStart4, 5 * 256, beatsin8(8, 10, 28), beat16(601));
+
+    pacifica_add_whitecaps(leds, n);
+    pacifica_deepen_colors(leds, n);
+}
+
+// The original Fire, from before fire.cpp, on a caller's heat buffer rather
+// than a static one. sparking is the original's SPARKING, or 0 for no sparks
+void reference_pattern_fire(CRGB *leds, uint8_t *heat, uint16_t n, uint8_t sparking)
+{
+    // Step 1.  Cool down every cell a little
+    for (int i = 0; i < n; i++)
+    {
+        heat[i] = qsub8(heat[i], 1);
+    }
+
+    // // Step 2.  Heat from each cell drifts 'up' and diffuses a little
+    // for (int k = NUM_LEDS - 1; k >= 2; k--)
+    // {
+    //     heat[k] = (heat[k - 1] + heat[k - 2] + heat[k - 2]) / 3;
+    // }
+
+    // Step 3.  Randomly ignite new 'sparks' of heat near the bottom
+    if (random8() < sparking)
+    {
+        int y = random8(n - 1);
+        heat[y] = qadd8(heat[y], random8(190, 255));
+    }
+
+    // Step 4.  Map from heat cells to LED colors
+    for (int j = 0; j < n; j++)
+    {
+        CRGB color = HeatColor(heat[j] / 2);
+        int pixelnumber = j;
+        leds[pixelnumber] = color;
+    }
+}
+
+// The original's Step 2, which it left commented out
+void reference_fire_drift(uint8_t *heat, uint16_t n)
+{
+    for (int k = n - 1; k >= 2; k--)
+    {
+        heat[k] = (heat[k - 1] + heat[k - 2] + heat[k - 2]) / 3;
+    }
+}
+
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,46 @@
+/**
+ * @file Arduino.cpp
+ * @author James Bennion-Pedley
+ * @brief Minimal Arduino shim for host-native builds
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <Arduino.h>
+
+/*----------------------------------- State ----------------------------------*/
+
+static uint64_t m_clock_us = 0;
+
+/*------------------------------- Public Functions ---------------------------*/
+
+uint32_t millis(void)
+{
+    return m_clock_us / 1000;
+}
+
+uint32_t micros(void)
+{
+    return m_clock_us;
+}
+
+void delay(uint32_t ms)
+{
+    native_clock_advance(ms);
+}
+
+void native_clock_set(uint32_t ms)
+{
+    m_clock_us = (uint64_t)ms * 1000;
+}
+
+void native_clock_advance(uint32_t ms)
+{
+    m_clock_us += (uint64_t)ms * 1000;
+}
+
+/*----------------------------------------------------------------------------*/
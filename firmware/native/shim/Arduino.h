@@ -0,0 +1,42 @@
+/**
+ * @file Arduino.h
+ * @author James Bennion-Pedley
+ * @brief Minimal Arduino shim for host-native builds
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef __FIRMWARE_NATIVE_SHIM_ARDUINO_H__
+#define __FIRMWARE_NATIVE_SHIM_ARDUINO_H__
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*---------------------------- Macros & Constants ----------------------------*/
+
+// Nothing runs from flash here
+#define IRAM_ATTR
+
+/*--------------------------------- Datatypes --------------------------------*/
+
+typedef uint8_t byte;
+
+/*--------------------------------- Functions --------------------------------*/
+
+// Virtual clock: only moves when the host program advances it
+uint32_t millis(void);
+uint32_t micros(void);
+void delay(uint32_t ms);
+
+void native_clock_set(uint32_t ms);
+void native_clock_advance(uint32_t ms);
+
+/*----------------------------------------------------------------------------*/
+
+#endif /* __FIRMWARE_NATIVE_SHIM_ARDUINO_H__ */
@@ -0,0 +1,264 @@
+/**
+ * @file FastLED.cpp
+ * @author James Bennion-Pedley
+ * @brief FastLED shim for host-native builds
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <FastLED.h>
+
+/*----------------------------------- State ----------------------------------*/
+
+CFastLED FastLED;
+
+uint16_t rand16seed = 1337;
+
+/*------------------------------- Public Functions ---------------------------*/
+
+void CFastLED::show(void)
+{
+    // Nothing is clocked out on the host; just count frames
+    m_frames++;
+}
+
+void CFastLED::clear(bool writeData)
+{
+    for (int i = 0; i < m_count; i++)
+        memset((void *)m_controllers[i].leds(), 0, m_controllers[i].size() * sizeof(CRGB));
+
+    if (writeData)
+        show();
+}
+
+CRGB ColorFromPalette(const CRGBPalette16 &pal, uint8_t index, uint8_t brightness, TBlendType blendType)
+{
+    if (blendType == LINEARBLEND_NOWRAP)
+        index = ((uint16_t)index * 240) >> 8;
+
+    uint8_t hi4 = index >> 4;
+    uint8_t lo4 = index & 0x0F;
+
+    const CRGB *entry = &(pal[hi4]);
+    uint8_t blend = lo4 && (blendType != NOBLEND);
+
+    uint8_t red1 = entry->red;
+    uint8_t green1 = entry->green;
+    uint8_t blue1 = entry->blue;
+
+    if (blend)
+    {
+        entry = (hi4 == 15) ? &(pal[0]) : entry + 1;
+
+        uint8_t f2 = lo4 << 4;
+        uint8_t f1 = 255 - f2;
+
+        red1 = scale8(red1, f1) + scale8(entry->red, f2);
+        green1 = scale8(green1, f1) + scale8(entry->green, f2);
+        blue1 = scale8(blue1, f1) + scale8(entry->blue, f2);
+    }
+
+    if (brightness != 255)
+    {
+        if (brightness)
+        {
+            ++brightness; // adjust for rounding
+            if (red1)
+                red1 = scale8(red1, brightness);
+            if (green1)
+                green1 = scale8(green1, brightness);
+            if (blue1)
+                blue1 = scale8(blue1, brightness);
+        }
+        else
+        {
+            red1 = green1 = blue1 = 0;
+        }
+    }
+
+    return CRGB(red1, green1, blue1);
+}
+
+CRGB HeatColor(uint8_t temperature)
+{
+    CRGB heatcolor;
+
+    // Scale 'heat' down from 0-255 to 0-191
+    uint8_t t192 = scale8_video(temperature, 191);
+
+    // Ramp up from zero to 252 in each 'third' of the scale
+    uint8_t heatramp = t192 & 0x3F;
+    heatramp <<= 2;
+
+    if (t192 & 0x80)
+        heatcolor.setRGB(255, 255, heatramp);
+    else if (t192 & 0x40)
+        heatcolor.setRGB(255, heatramp, 0);
+    else
+        heatcolor.setRGB(heatramp, 0, 0);
+
+    return heatcolor;
+}
+
+CRGB &nblend(CRGB &existing, const CRGB &overlay, fract8 amountOfOverlay)
+{
+    if (amountOfOverlay == 0)
+        return existing;
+
+    if (amountOfOverlay == 255)
+    {
+        existing = overlay;
+        return existing;
+    }
+
+    existing.red = blend8(existing.red, overlay.red, amountOfOverlay);
+    existing.green = blend8(existing.green, overlay.green, amountOfOverlay);
+    existing.blue = blend8(existing.blue, overlay.blue, amountOfOverlay);
+
+    return existing;
+}
+
+void fill_solid(CRGB *leds, int numToFill, const CRGB &color)
+{
+    for (int i = 0; i < numToFill; i++)
+        leds[i] = color;
+}
+
+void hsv2rgb_rainbow(const CHSV &hsv, CRGB &rgb)
+{
+    uint8_t hue = hsv.hue;
+    uint8_t sat = hsv.sat;
+    uint8_t val = hsv.val;
+
+    uint8_t offset = hue & 0x1F; // 0..31
+    uint8_t offset8 = offset << 3;
+    uint8_t third = scale8(offset8, (256 / 3)); // max = 85
+
+    uint8_t r, g, b;
+
+    if (!(hue & 0x80))
+    {
+        if (!(hue & 0x40))
+        {
+            if (!(hue & 0x20))
+            {
+                // R -> O
+                r = 255 - third;
+                g = third;
+                b = 0;
+            }
+            else
+            {
+                // O -> Y
+                r = 171;
+                g = 85 + third;
+                b = 0;
+            }
+        }
+        else
+        {
+            if (!(hue & 0x20))
+            {
+                // Y -> G
+                uint8_t twothirds = scale8(offset8, ((256 * 2) / 3)); // max = 170
+                r = 171 - twothirds;
+                g = 170 + third;
+                b = 0;
+            }
+            else
+            {
+                // G -> A
+                r = 0;
+                g = 255 - third;
+                b = third;
+            }
+        }
+    }
+    else
+    {
+        if (!(hue & 0x40))
+        {
+            if (!(hue & 0x20))
+            {
+                // A -> B
+                uint8_t twothirds = scale8(offset8, ((256 * 2) / 3)); // max = 170
+                r = 0;
+                g = 171 - twothirds;
+                b = 85 + twothirds;
+            }
+            else
+            {
+                // B -> P
+                r = third;
+                g = 0;
+                b = 255 - third;
+            }
+        }
+        else
+        {
+            if (!(hue & 0x20))
+            {
+                // P -> K
+                r = 85 + third;
+                g = 0;
+                b = 171 - third;
+            }
+            else
+            {
+                // K -> R
+                r = 170 + third;
+                g = 0;
+                b = 85 - third;
+            }
+        }
+    }
+
+    // Scale down colours if we're desaturated at all
+    if (sat != 255)
+    {
+        if (sat == 0)
+        {
+            r = 255;
+            g = 255;
+            b = 255;
+        }
+        else
+        {
+            uint8_t desat = 255 - sat;
+            desat = scale8_video(desat, desat);
+
+            uint8_t satscale = 255 - desat;
+            r = scale8(r, satscale) + desat;
+            g = scale8(g, satscale) + desat;
+            b = scale8(b, satscale) + desat;
+        }
+    }
+
+    // Scale everything down if we're at value < 255
+    if (val != 255)
+    {
+        val = scale8_video(val, val);
+        if (val == 0)
+        {
+            r = 0;
+            g = 0;
+            b = 0;
+        }
+        else
+        {
+            r = scale8(r, val);
+            g = scale8(g, val);
+            b = scale8(b, val);
+        }
+    }
+
+    rgb.r = r;
+    rgb.g = g;
+    rgb.b = b;
+}
+
+/*----------------------------------------------------------------------------*/
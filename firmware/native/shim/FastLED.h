@@ -0,0 +1,466 @@
+/**
+ * @file FastLED.h
+ * @author James Bennion-Pedley
+ * @brief FastLED shim for host-native builds
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * Portable C ports of the FastLED 3.6 routines used by the firmware, with the
+ * same arithmetic as the ESP8266 build (FASTLED_SCALE8_FIXED, FASTLED_BLEND_FIXED
+ * and the C sin8/sin16 approximations), so host output and timings are
+ * representative of the device.
+ *
+ */
+
+#ifndef __FIRMWARE_NATIVE_SHIM_FASTLED_H__
+#define __FIRMWARE_NATIVE_SHIM_FASTLED_H__
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <Arduino.h>
+
+/*---------------------------- Macros & Constants ----------------------------*/
+
+#define FASTLED_VERSION 3006000
+
+#define LIB8STATIC static inline
+
+#if !defined(USE_GET_MILLISECOND_TIMER)
+#define GET_MILLIS millis
+#else
+uint32_t get_millisecond_timer(void);
+#define GET_MILLIS get_millisecond_timer
+#endif
+
+/*--------------------------------- Datatypes --------------------------------*/
+
+typedef uint8_t fract8;
+typedef uint16_t fract16;
+typedef uint16_t accum88;
+
+enum EOrder
+{
+    RGB = 0012,
+    RBG = 0021,
+    GRB = 0102,
+    GBR = 0120,
+    BRG = 0201,
+    BGR = 0210
+};
+
+enum LEDColorCorrection
+{
+    TypicalSMD5050 = 0xFFB0F0,
+    TypicalLEDStrip = 0xFFB0F0,
+    UncorrectedColor = 0xFFFFFF
+};
+
+enum TBlendType
+{
+    NOBLEND = 0,
+    LINEARBLEND = 1,
+    LINEARBLEND_NOWRAP = 2
+};
+
+/*------------------------------ lib8tion Math -------------------------------*/
+
+LIB8STATIC uint8_t qadd8(uint8_t i, uint8_t j)
+{
+    unsigned int t = i + j;
+    return (t > 255) ? 255 : t;
+}
+
+LIB8STATIC uint8_t qsub8(uint8_t i, uint8_t j)
+{
+    int t = i - j;
+    return (t < 0) ? 0 : t;
+}
+
+LIB8STATIC uint8_t scale8(uint8_t i, fract8 scale)
+{
+    return (((uint16_t)i) * (1 + (uint16_t)(scale))) >> 8;
+}
+
+LIB8STATIC uint8_t scale8_video(uint8_t i, fract8 scale)
+{
+    return (((int)i * (int)scale) >> 8) + ((i && scale) ? 1 : 0);
+}
+
+LIB8STATIC uint16_t scale16(uint16_t i, fract16 scale)
+{
+    return ((uint32_t)(i) * (1 + (uint32_t)(scale))) / 65536;
+}
+
+LIB8STATIC uint8_t blend8(uint8_t a, uint8_t b, uint8_t amountOfB)
+{
+    uint16_t partial = (a << 8) | b;
+    partial += (b * amountOfB);
+    partial -= (a * amountOfB);
+    return partial >> 8;
+}
+
+LIB8STATIC int16_t sin16(uint16_t theta)
+{
+    static const uint16_t base[] = {0, 6393, 12539, 18204, 23170, 27245, 30273, 32137};
+    static const uint8_t slope[] = {49, 48, 44, 38, 31, 23, 14, 4};
+
+    uint16_t offset = (theta & 0x3FFF) >> 3; // 0..2047
+    if (theta & 0x4000)
+        offset = 2047 - offset;
+
+    uint8_t section = offset / 256; // 0..7
+    uint16_t b = base[section];
+    uint8_t m = slope[section];
+
+    uint8_t secoffset8 = (uint8_t)(offset) / 2;
+
+    uint16_t mx = m * secoffset8;
+    int16_t y = mx + b;
+
+    if (theta & 0x8000)
+        y = -y;
+
+    return y;
+}
+
+LIB8STATIC int16_t cos16(uint16_t theta)
+{
+    return sin16(theta + 16384);
+}
+
+LIB8STATIC uint8_t sin8(uint8_t theta)
+{
+    static const uint8_t b_m16_interleave[] = {0, 49, 49, 41, 90, 27, 117, 10};
+
+    uint8_t offset = theta;
+    if (theta & 0x40)
+        offset = (uint8_t)255 - offset;
+    offset &= 0x3F; // 0..63
+
+    uint8_t secoffset = offset & 0x0F; // 0..15
+    if (theta & 0x40)
+        ++secoffset;
+
+    uint8_t section = offset >> 4; // 0..3
+    uint8_t b = b_m16_interleave[section * 2];
+    uint8_t m16 = b_m16_interleave[section * 2 + 1];
+
+    uint8_t mx = (m16 * secoffset) >> 4;
+
+    int8_t y = mx + b;
+    if (theta & 0x80)
+        y = -y;
+
+    y += 128;
+
+    return y;
+}
+
+LIB8STATIC uint8_t cos8(uint8_t theta)
+{
+    return sin8(theta + 64);
+}
+
+/*------------------------------ lib8tion Random -----------------------------*/
+
+extern uint16_t rand16seed;
+
+LIB8STATIC uint8_t random8(void)
+{
+    rand16seed = (rand16seed * 2053) + 13849;
+    return (uint8_t)(((uint8_t)(rand16seed & 0xFF)) + ((uint8_t)(rand16seed >> 8)));
+}
+
+LIB8STATIC uint8_t random8(uint8_t lim)
+{
+    uint8_t r = random8();
+    r = (r * lim) >> 8;
+    return r;
+}
+
+LIB8STATIC uint8_t random8(uint8_t min, uint8_t lim)
+{
+    uint8_t delta = lim - min;
+    return random8(delta) + min;
+}
+
+LIB8STATIC uint16_t random16(void)
+{
+    rand16seed = (rand16seed * 2053) + 13849;
+    return rand16seed;
+}
+
+LIB8STATIC uint16_t random16(uint16_t lim)
+{
+    uint16_t r = random16();
+    uint32_t p = (uint32_t)lim * (uint32_t)r;
+    return p >> 16;
+}
+
+LIB8STATIC void random16_set_seed(uint16_t seed)
+{
+    rand16seed = seed;
+}
+
+/*------------------------------ lib8tion Timing -----------------------------*/
+
+LIB8STATIC uint16_t beat88(accum88 beats_per_minute_88, uint32_t timebase = 0)
+{
+    return (((GET_MILLIS()) - timebase) * beats_per_minute_88 * 280) >> 16;
+}
+
+LIB8STATIC uint16_t beat16(accum88 beats_per_minute, uint32_t timebase = 0)
+{
+    if (beats_per_minute < 256)
+        beats_per_minute <<= 8;
+    return beat88(beats_per_minute, timebase);
+}
+
+LIB8STATIC uint8_t beat8(accum88 beats_per_minute, uint32_t timebase = 0)
+{
+    return beat16(beats_per_minute, timebase) >> 8;
+}
+
+LIB8STATIC uint16_t beatsin88(accum88 beats_per_minute_88, uint16_t lowest = 0, uint16_t highest = 65535,
+                              uint32_t timebase = 0, uint16_t phase_offset = 0)
+{
+    uint16_t beat = beat88(beats_per_minute_88, timebase);
+    uint16_t beatsin = (sin16(beat + phase_offset) + 32768);
+    uint16_t rangewidth = highest - lowest;
+    uint16_t scaledbeat = scale16(beatsin, rangewidth);
+    return lowest + scaledbeat;
+}
+
+LIB8STATIC uint16_t beatsin16(accum88 beats_per_minute, uint16_t lowest = 0, uint16_t highest = 65535,
+                              uint32_t timebase = 0, uint16_t phase_offset = 0)
+{
+    uint16_t beat = beat16(beats_per_minute, timebase);
+    uint16_t beatsin = (sin16(beat + phase_offset) + 32768);
+    uint16_t rangewidth = highest - lowest;
+    uint16_t scaledbeat = scale16(beatsin, rangewidth);
+    return lowest + scaledbeat;
+}
+
+LIB8STATIC uint8_t beatsin8(accum88 beats_per_minute, uint8_t lowest = 0, uint8_t highest = 255,
+                            uint32_t timebase = 0, uint8_t phase_offset = 0)
+{
+    uint8_t beat = beat8(beats_per_minute, timebase);
+    uint8_t beatsin = sin8(beat + phase_offset);
+    uint8_t rangewidth = highest - lowest;
+    uint8_t scaledbeat = scale8(beatsin, rangewidth);
+    return lowest + scaledbeat;
+}
+
+/*--------------------------------- Colours ----------------------------------*/
+
+struct CHSV
+{
+    union
+    {
+        struct
+        {
+            uint8_t hue;
+            uint8_t sat;
+            uint8_t val;
+        };
+        uint8_t raw[3];
+    };
+
+    inline CHSV() = default;
+    inline CHSV(uint8_t ih, uint8_t is, uint8_t iv) : hue(ih), sat(is), val(iv) {}
+};
+
+struct CRGB;
+void hsv2rgb_rainbow(const CHSV &hsv, CRGB &rgb);
+
+struct CRGB
+{
+    union
+    {
+        struct
+        {
+            union
+            {
+                uint8_t r;
+                uint8_t red;
+            };
+            union
+            {
+                uint8_t g;
+                uint8_t green;
+            };
+            union
+            {
+                uint8_t b;
+                uint8_t blue;
+            };
+        };
+        uint8_t raw[3];
+    };
+
+    inline CRGB() = default;
+    inline constexpr CRGB(uint8_t ir, uint8_t ig, uint8_t ib) : r(ir), g(ig), b(ib) {}
+    inline constexpr CRGB(uint32_t colorcode)
+        : r((colorcode >> 16) & 0xFF), g((colorcode >> 8) & 0xFF), b((colorcode >> 0) & 0xFF) {}
+    inline CRGB(const CHSV &rhs) { hsv2rgb_rainbow(rhs, *this); }
+
+    inline uint8_t &operator[](uint8_t x) { return raw[x]; }
+    inline const uint8_t &operator[](uint8_t x) const { return raw[x]; }
+
+    inline CRGB &setRGB(uint8_t nr, uint8_t ng, uint8_t nb)
+    {
+        r = nr;
+        g = ng;
+        b = nb;
+        return *this;
+    }
+
+    inline CRGB &operator+=(const CRGB &rhs)
+    {
+        r = qadd8(r, rhs.r);
+        g = qadd8(g, rhs.g);
+        b = qadd8(b, rhs.b);
+        return *this;
+    }
+
+    inline CRGB &operator-=(const CRGB &rhs)
+    {
+        r = qsub8(r, rhs.r);
+        g = qsub8(g, rhs.g);
+        b = qsub8(b, rhs.b);
+        return *this;
+    }
+
+    inline CRGB &operator|=(const CRGB &rhs)
+    {
+        if (rhs.r > r)
+            r = rhs.r;
+        if (rhs.g > g)
+            g = rhs.g;
+        if (rhs.b > b)
+            b = rhs.b;
+        return *this;
+    }
+
+    inline CRGB &subtractFromRGB(uint8_t d)
+    {
+        r = qsub8(r, d);
+        g = qsub8(g, d);
+        b = qsub8(b, d);
+        return *this;
+    }
+
+    inline CRGB &nscale8(uint8_t scaledown)
+    {
+        r = scale8(r, scaledown);
+        g = scale8(g, scaledown);
+        b = scale8(b, scaledown);
+        return *this;
+    }
+
+    inline uint8_t getAverageLight(void) const
+    {
+        const uint8_t eightyfive = 85;
+        return scale8(r, eightyfive) + scale8(g, eightyfive) + scale8(b, eightyfive);
+    }
+
+    inline bool operator==(const CRGB &rhs) const
+    {
+        return (r == rhs.r) && (g == rhs.g) && (b == rhs.b);
+    }
+
+    inline bool operator!=(const CRGB &rhs) const
+    {
+        return !(*this == rhs);
+    }
+};
+
+class CRGBPalette16
+{
+public:
+    CRGB entries[16];
+
+    CRGBPalette16() = default;
+    CRGBPalette16(const CRGB &c00, const CRGB &c01, const CRGB &c02, const CRGB &c03,
+                  const CRGB &c04, const CRGB &c05, const CRGB &c06, const CRGB &c07,
+                  const CRGB &c08, const CRGB &c09, const CRGB &c10, const CRGB &c11,
+                  const CRGB &c12, const CRGB &c13, const CRGB &c14, const CRGB &c15)
+        : entries{c00, c01, c02, c03, c04, c05, c06, c07, c08, c09, c10, c11, c12, c13, c14, c15} {}
+
+    inline CRGB &operator[](uint8_t x) { return entries[x]; }
+    inline const CRGB &operator[](uint8_t x) const { return entries[x]; }
+};
+
+CRGB ColorFromPalette(const CRGBPalette16 &pal, uint8_t index, uint8_t brightness = 255,
+                      TBlendType blendType = LINEARBLEND);
+CRGB HeatColor(uint8_t temperature);
+CRGB &nblend(CRGB &existing, const CRGB &overlay, fract8 amountOfOverlay);
+void fill_solid(CRGB *leds, int numToFill, const CRGB &color);
+
+/*-------------------------------- Controller --------------------------------*/
+
+template <uint8_t DATA_PIN, EOrder RGB_ORDER>
+class WS2812B
+{
+};
+
+class CLEDController
+{
+public:
+    CRGB *m_data = nullptr;
+    int m_nLeds = 0;
+
+    CLEDController &setCorrection(LEDColorCorrection correction)
+    {
+        (void)correction;
+        return *this;
+    }
+
+    CLEDController &setLeds(CRGB *data, int nLeds)
+    {
+        m_data = data;
+        m_nLeds = nLeds;
+        return *this;
+    }
+
+    CRGB *leds(void) { return m_data; }
+    int size(void) { return m_nLeds; }
+};
+
+#define NATIVE_MAX_CONTROLLERS 8
+
+class CFastLED
+{
+public:
+    template <template <uint8_t DATA_PIN, EOrder RGB_ORDER> class CHIPSET, uint8_t DATA_PIN, EOrder RGB_ORDER>
+    CLEDController &addLeds(CRGB *data, int nLeds)
+    {
+        CLEDController &c = m_controllers[m_count < NATIVE_MAX_CONTROLLERS ? m_count++ : m_count - 1];
+        return c.setLeds(data, nLeds);
+    }
+
+    void setBrightness(uint8_t scale) { m_scale = scale; }
+    uint8_t getBrightness(void) { return m_scale; }
+
+    void show(void);
+    void clear(bool writeData = false);
+
+    int count(void) { return m_count; }
+    CLEDController &operator[](int x) { return m_controllers[x]; }
+
+    // Number of show() calls, for host tooling
+    uint32_t frames(void) { return m_frames; }
+
+private:
+    CLEDController m_controllers[NATIVE_MAX_CONTROLLERS];
+    int m_count = 0;
+    uint8_t m_scale = 255;
+    uint32_t m_frames = 0;
+};
+
+extern CFastLED FastLED;
+
+/*----------------------------------------------------------------------------*/
+
+#endif /* __FIRMWARE_NATIVE_SHIM_FASTLED_H__ */
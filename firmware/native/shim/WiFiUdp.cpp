@@ -0,0 +1,92 @@
+/**
+ * @file WiFiUdp.cpp
+ * @author James Bennion-Pedley
+ * @brief ESP8266 WiFiUDP shim over POSIX sockets, for host-native builds
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <WiFiUdp.h>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/*------------------------------- Public Functions ---------------------------*/
+
+WiFiUDP::~WiFiUDP()
+{
+    stop();
+}
+
+uint8_t WiFiUDP::begin(uint16_t port)
+{
+    stop();
+
+    m_fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (m_fd < 0)
+        return 0;
+
+    // Room for a burst of frames, like the lwIP pbuf queue
+    int rcvbuf = 1 << 20;
+    setsockopt(m_fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+
+    if (bind(m_fd, (sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+        stop();
+        return 0;
+    }
+
+    fcntl(m_fd, F_SETFL, fcntl(m_fd, F_GETFL) | O_NONBLOCK);
+    return 1;
+}
+
+void WiFiUDP::stop(void)
+{
+    if (m_fd >= 0)
+        close(m_fd);
+    m_fd = -1;
+}
+
+int WiFiUDP::parsePacket(void)
+{
+    // Whatever is left of the previous datagram is discarded
+    m_len = m_pos = 0;
+    if (m_fd < 0)
+        return 0;
+
+    ssize_t n = recv(m_fd, m_packet, sizeof(m_packet), 0);
+    if (n <= 0)
+        return 0;
+
+    m_len = n;
+    return n;
+}
+
+int WiFiUDP::available(void)
+{
+    return m_len - m_pos;
+}
+
+int WiFiUDP::read(uint8_t *buffer, size_t len)
+{
+    if (len > m_len - m_pos)
+        len = m_len - m_pos;
+
+    memcpy(buffer, &m_packet[m_pos], len);
+    m_pos += len;
+    return len;
+}
+
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,42 @@
+/**
+ * @file WiFiUdp.h
+ * @author James Bennion-Pedley
+ * @brief ESP8266 WiFiUDP shim over POSIX sockets, for host-native builds
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef __FIRMWARE_NATIVE_SHIM_WIFIUDP_H__
+#define __FIRMWARE_NATIVE_SHIM_WIFIUDP_H__
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <Arduino.h>
+
+/*--------------------------------- Datatypes --------------------------------*/
+
+// Receive side only: one datagram is buffered at a time, as on the ESP8266
+class WiFiUDP
+{
+  public:
+    ~WiFiUDP();
+
+    uint8_t begin(uint16_t port);
+    void stop(void);
+
+    int parsePacket(void);
+    int available(void);
+    int read(uint8_t *buffer, size_t len);
+
+  private:
+    int m_fd = -1;
+    uint8_t m_packet[1500];
+    size_t m_len = 0;
+    size_t m_pos = 0;
+};
+
+/*----------------------------------------------------------------------------*/
+
+#endif /* __FIRMWARE_NATIVE_SHIM_WIFIUDP_H__ */
@@ -0,0 +1,374 @@
+/**
+ * @file sim.cpp
+ * @author James Bennion-Pedley
+ * @brief Deterministic pattern simulator with image, terminal and golden output
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <FastLED.h>
+
+#include <sys/stat.h>
+
+#include "audio.h"
+#include "leds.h"
+#include "native.h"
+#include "patterns.h"
+#include "protocol.h"
+#include "vm.h"
+
+/*---------------------------- Macros & Constants ----------------------------*/
+
+#define SIM_TERM_WIDTH 100 // Pixels shown per terminal line
+#define SIM_MUSIC_BPM 120
+
+// Committed golden frames, relative to firmware/ where the tool is run
+#define SIM_GOLDEN_DIR "native/golden"
+
+/*--------------------------------- Datatypes --------------------------------*/
+
+// Everything a run depends on. Golden files start with it, so a comparison
+// replays exactly what was recorded
+typedef struct
+{
+    uint16_t leds;
+    uint16_t fps;
+    uint32_t seconds;
+    uint32_t start; // Shared time of the first frame, ms
+    uint32_t seed;
+    uint8_t cols[3];
+} sim_run_t;
+
+typedef struct
+{
+    sim_run_t run;
+    pattern_id_t pattern; // PATTERN_COUNT for all of them
+    const char *ppm;
+    const char *record;
+    const char *compare;
+    bool term;
+    bool check;  // Against every committed run
+    bool update; // Record the committed runs again instead
+} sim_options_t;
+
+// A committed run, kept in its own directory under SIM_GOLDEN_DIR
+typedef struct
+{
+    const char *name;
+    sim_run_t run;
+} sim_check_t;
+
+/*----------------------------------- State ----------------------------------*/
+
+// From a cold start, and an hour in with another seed and colour, so a
+// change to either path through a pattern shows up
+static const sim_check_t m_checks[] = {
+    {"cold", {60, 25, 8, 0, 1, {6, 15, 141}}},
+    {"hour", {60, 25, 8, 3600000, 2654435761UL, {255, 96, 0}}},
+};
+
+/*------------------------------ Private Functions ---------------------------*/
+
+static bool parse_options(sim_options_t &opts, int argc, char **argv)
+{
+    memset(&opts, 0, sizeof(opts));
+    opts.run.leds = 60;
+    opts.run.fps = 50;
+    opts.run.seconds = 10;
+    opts.run.cols[0] = 6;
+    opts.run.cols[1] = 15;
+    opts.run.cols[2] = 141;
+    opts.pattern = PATTERN_COUNT;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool more = i + 1 < argc;
+        if (!strcmp(argv[i], "--pattern") && more)
+        {
+            opts.pattern = patterns_find(argv[++i]);
+            if (opts.pattern == PATTERN_COUNT)
+                return false;
+        }
+        else if (!strcmp(argv[i], "--leds") && more)
+            opts.run.leds = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--fps") && more)
+            opts.run.fps = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--seconds") && more)
+            opts.run.seconds = strtoul(argv[++i], nullptr, 10);
+        else if (!strcmp(argv[i], "--start") && more)
+            opts.run.start = strtoul(argv[++i], nullptr, 10);
+        else if (!strcmp(argv[i], "--seed") && more)
+            opts.run.seed = strtoul(argv[++i], nullptr, 10);
+        else if (!strcmp(argv[i], "--colour") && more)
+        {
+            if (!protocol_str_to_colour(argv[++i], opts.run.cols))
+                return false;
+        }
+        else if (!strcmp(argv[i], "--ppm") && more)
+            opts.ppm = argv[++i];
+        else if (!strcmp(argv[i], "--record") && more)
+            opts.record = argv[++i];
+        else if (!strcmp(argv[i], "--compare") && more)
+            opts.compare = argv[++i];
+        else if (!strcmp(argv[i], "--term"))
+            opts.term = true;
+        else if (!strcmp(argv[i], "--check"))
+            opts.check = true;
+        else if (!strcmp(argv[i], "--update"))
+            opts.update = true;
+        else
+            return false;
+    }
+
+    if (opts.run.leds == 0 || opts.run.leds > NUM_LEDS || opts.run.fps == 0)
+        return false;
+
+    // The committed runs bring their own options and directories
+    if (opts.update && !opts.check)
+        return false;
+    if (opts.check && (opts.record != nullptr || opts.compare != nullptr || opts.ppm != nullptr || opts.term))
+        return false;
+
+    // An image or preview is of one pattern
+    return (opts.ppm == nullptr && !opts.term) || opts.pattern != PATTERN_COUNT;
+}
+
+static uint32_t frame_hash(const CRGB *leds, uint16_t n)
+{
+    const uint8_t *bytes = (const uint8_t *)leds;
+    uint32_t hash = 2166136261UL;
+    for (size_t i = 0; i < n * sizeof(CRGB); i++)
+        hash = (hash ^ bytes[i]) * 16777619UL;
+    return hash;
+}
+
+static void print_term(const CRGB *leds, uint16_t n, uint32_t t)
+{
+    printf("%8u ", t);
+    for (uint16_t i = 0; i < n && i < SIM_TERM_WIDTH; i++)
+        printf("\x1b[48;2;%u;%u;%um ", leds[i].r, leds[i].g, leds[i].b);
+    printf("\x1b[0m\n");
+}
+
+static void golden_path(char *dest, size_t size, const char *dir, pattern_id_t id)
+{
+    snprintf(dest, size, "%s/%s.golden", dir, patterns_get(id)->name);
+}
+
+static bool read_golden_header(FILE *f, sim_run_t *run)
+{
+    unsigned leds, fps, r, g, b;
+    unsigned long seconds, start, seed;
+    if (fscanf(f, "leds %u fps %u seconds %lu start %lu seed %lu colour %u %u %u\n",
+               &leds, &fps, &seconds, &start, &seed, &r, &g, &b) != 8)
+        return false;
+
+    run->leds = leds;
+    run->fps = fps;
+    run->seconds = seconds;
+    run->start = start;
+    run->seed = seed;
+    run->cols[0] = r;
+    run->cols[1] = g;
+    run->cols[2] = b;
+
+    return run->leds > 0 && run->leds <= NUM_LEDS && run->fps > 0;
+}
+
+// Renders one pattern from a clean start. With a golden file open for
+// reading, returns the number of frames that differ from it
+static uint32_t simulate(pattern_id_t id, const sim_run_t *run, const sim_options_t &opts,
+                         FILE *golden_in, FILE *golden_out, FILE *ppm)
+{
+    leds_config_t cfg;
+    leds_default_config(&cfg);
+    cfg.strips[0].length = run->leds;
+    leds_configure(&cfg);
+
+    // Nothing carries over from whatever ran before
+    leds_frame_t blank = {run->start, run->seed, run->cols};
+    patterns_render(PATTERN_OFF, &blank);
+    patterns_start(id);
+
+    // Custom runs the built-in Rainbow as a program, and Music hears a
+    // synthetic track as it would have been sampled, so neither stays black
+    vm_program_t prog;
+    if (id == PATTERN_CUSTOM && vm_verify(vm_rainbow, vm_rainbow_length, &prog) == VM_OK)
+        vm_install(&prog);
+
+    std::vector<uint16_t> track;
+    if (id == PATTERN_MUSIC)
+        track = music_synthesise(SIM_MUSIC_BPM, run->seconds + 1);
+    uint32_t sampled = 0;
+
+    CRGB *leds = FastLED[0].leds();
+    uint32_t frames = run->seconds * run->fps;
+    uint32_t mismatches = 0, first = 0;
+
+    for (uint32_t f = 0; f < frames; f++)
+    {
+        uint32_t t = run->start + (uint32_t)(((uint64_t)f * 1000) / run->fps);
+        native_clock_set(t);
+
+        uint32_t due = ((uint64_t)f * AUDIO_SAMPLE_HZ) / run->fps;
+        for (; sampled < due && sampled < track.size(); sampled++)
+            audio_push(track[sampled]);
+
+        leds_frame_t frame = {t, run->seed, run->cols};
+        patterns_render(id, &frame);
+        uint32_t hash = frame_hash(leds, run->leds);
+
+        if (golden_out != nullptr)
+            fprintf(golden_out, "%u %u %08x\n", f, t, hash);
+
+        if (golden_in != nullptr)
+        {
+            unsigned gf, gt, ghash;
+            if (fscanf(golden_in, "%u %u %x\n", &gf, &gt, &ghash) != 3 || gf != f || gt != t || ghash != hash)
+            {
+                if (mismatches++ == 0)
+                    first = f;
+            }
+        }
+
+        if (ppm != nullptr)
+            fwrite(leds, sizeof(CRGB), run->leds, ppm);
+
+        if (opts.term)
+            print_term(leds, run->leds, t);
+    }
+
+    vm_install(nullptr);
+
+    if (golden_in != nullptr)
+    {
+        if (mismatches)
+            printf("%-10s FAIL: %u of %u frames differ, first at frame %u (t = %u ms)\n",
+                   patterns_get(id)->name, mismatches, frames, first,
+                   run->start + (uint32_t)(((uint64_t)first * 1000) / run->fps));
+        else
+            printf("%-10s OK: %u frames match\n", patterns_get(id)->name, frames);
+    }
+
+    return mismatches;
+}
+
+// Each selected pattern in turn; returns how many failed to match or record
+static uint32_t simulate_all(const sim_options_t &opts)
+{
+    uint32_t failures = 0;
+
+    for (int i = 0; i < PATTERN_COUNT; i++)
+    {
+        pattern_id_t id = (pattern_id_t)i;
+
+        // Streamed frames come from outside, there's nothing to simulate
+        if ((opts.pattern != PATTERN_COUNT && id != opts.pattern) || id == PATTERN_STREAM)
+            continue;
+
+        char path[256];
+        sim_run_t run = opts.run;
+        FILE *golden_in = nullptr, *golden_out = nullptr, *ppm = nullptr;
+
+        if (opts.compare != nullptr)
+        {
+            golden_path(path, sizeof(path), opts.compare, id);
+            golden_in = fopen(path, "r");
+            if (golden_in == nullptr || !read_golden_header(golden_in, &run))
+            {
+                printf("%-10s FAIL: no golden frames in %s\n", patterns_get(id)->name, path);
+                if (golden_in != nullptr)
+                    fclose(golden_in);
+                failures++;
+                continue;
+            }
+        }
+
+        if (opts.record != nullptr)
+        {
+            golden_path(path, sizeof(path), opts.record, id);
+            golden_out = fopen(path, "w");
+            if (golden_out == nullptr)
+            {
+                printf("%-10s FAIL: can't write %s\n", patterns_get(id)->name, path);
+                failures++;
+                continue;
+            }
+            fprintf(golden_out, "leds %u fps %u seconds %u start %u seed %u colour %u %u %u\n",
+                    run.leds, run.fps, run.seconds, run.start, run.seed, run.cols[0], run.cols[1], run.cols[2]);
+        }
+
+        // One row per frame, so time runs down the image
+        if (opts.ppm != nullptr)
+        {
+            ppm = fopen(opts.ppm, "wb");
+            if (ppm == nullptr)
+            {
+                printf("%-10s FAIL: can't write %s\n", patterns_get(id)->name, opts.ppm);
+                failures++;
+                continue;
+            }
+            fprintf(ppm, "P6\n%u %u\n255\n", run.leds, run.seconds * run.fps);
+        }
+
+        failures += simulate(id, &run, opts, golden_in, golden_out, ppm) ? 1 : 0;
+
+        if (golden_in != nullptr)
+            fclose(golden_in);
+        if (golden_out != nullptr)
+            fclose(golden_out);
+        if (ppm != nullptr)
+            fclose(ppm);
+    }
+
+    return failures;
+}
+
+/*------------------------------- Public Functions ---------------------------*/
+
+int sim_main(int argc, char **argv)
+{
+    sim_options_t opts;
+    if (!parse_options(opts, argc, argv))
+        return 1;
+
+    leds_config_t cfg;
+    leds_default_config(&cfg);
+    leds_initialise(&cfg);
+
+    if (!opts.check)
+        return simulate_all(opts) ? 1 : 0;
+
+    if (opts.update)
+        mkdir(SIM_GOLDEN_DIR, 0755);
+
+    uint32_t failures = 0;
+    for (const sim_check_t &check : m_checks)
+    {
+        char dir[256];
+        snprintf(dir, sizeof(dir), "%s/%s", SIM_GOLDEN_DIR, check.name);
+        printf("%s:\n", dir);
+
+        sim_options_t run_opts = opts;
+        run_opts.run = check.run;
+        if (opts.update)
+        {
+            mkdir(dir, 0755);
+            run_opts.record = dir;
+        }
+        else
+        {
+            run_opts.compare = dir;
+        }
+
+        failures += simulate_all(run_opts);
+    }
+
+    return failures ? 1 : 0;
+}
+
+/*----------------------------------------------------------------------------*/
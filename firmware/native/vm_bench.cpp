@@ -0,0 +1,211 @@
+/**
+ * @file vm_bench.cpp
+ * @author James Bennion-Pedley
+ * @brief Bytecode VM checks, and interpreted against native Rainbow
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <Arduino.h>
+
+#include <chrono>
+
+#include "leds.h"
+#include "native.h"
+#include "patterns.h"
+#include "vm.h"
+
+/*---------------------------- Macros & Constants ----------------------------*/
+
+#define VM_CHECK_LEDS 300
+#define VM_RATE_FRAMES 2000
+
+/*--------------------------------- Datatypes --------------------------------*/
+
+typedef struct
+{
+    const char *name;
+    std::vector<uint8_t> body;
+    vm_result_t expected;
+} vm_case_t;
+
+/*----------------------------------- State ----------------------------------*/
+
+static uint8_t m_colours[3] = {6, 15, 141};
+
+// firmware/tools/rainbow.vms, from: vmc.py rainbow.vms --c vm_rainbow
+const uint8_t vm_rainbow[] = {
+    0x56, 0x4d, 0x01, 0x00, 0x31, 0x00, 0x41, 0x00, 0x00, 0x57, 0x00, 0xdc,
+    0x00, 0xfa, 0x22, 0x04, 0x00, 0x01, 0x55, 0x01, 0x00, 0x60, 0x00, 0xe0,
+    0x22, 0x04, 0x01, 0x00, 0xcb, 0x01, 0x00, 0x19, 0x01, 0x00, 0x28, 0x22,
+    0x04, 0x02, 0x00, 0x71, 0x00, 0x01, 0x01, 0xb8, 0x0b, 0x22, 0x04, 0x03,
+    0x07, 0x04, 0x04, 0x07, 0x00, 0x28, 0x0d, 0x04, 0x05, 0x03, 0x04, 0x03,
+    0x03, 0x0b, 0x04, 0x04, 0x03, 0x05, 0x03, 0x02, 0x0b, 0x04, 0x05, 0x03,
+    0x05, 0x1f, 0x02, 0x00, 0x80, 0x00, 0x00, 0x0b, 0x04, 0x06, 0x03, 0x06,
+    0x03, 0x06, 0x0d, 0x00, 0x10, 0x14, 0x04, 0x07, 0x03, 0x07, 0x03, 0x01,
+    0x0d, 0x00, 0x10, 0x14, 0x00, 0xff, 0x0b, 0x03, 0x01, 0x0c, 0x04, 0x08,
+    0x0a, 0x03, 0x04, 0x00, 0x08, 0x14, 0x03, 0x00, 0x03, 0x08, 0x26, 0x00,
+    0x40, 0x29,
+};
+const unsigned int vm_rainbow_length = sizeof(vm_rainbow);
+
+// Each one breaks a different promise the interpreter relies on
+static const vm_case_t m_cases[] = {
+    {"colour", {VM_OP_COLOUR}, VM_OK},
+    {"select", {VM_OP_INDEX, VM_OP_JZ, 3, VM_OP_COLOUR, VM_OP_JMP, 2, VM_OP_PUSH8, 0}, VM_OK},
+    {"unknown opcode", {VM_OP_COUNT}, VM_ERR_OPCODE},
+    {"truncated", {VM_OP_PUSH16, 1}, VM_ERR_TRUNCATED},
+    {"mid-instruction jump", {VM_OP_PUSH8, 1, VM_OP_JZ, 1, VM_OP_PUSH16, 0, 0}, VM_ERR_JUMP},
+    {"jump past the end", {VM_OP_PUSH8, 1, VM_OP_JMP, 3}, VM_ERR_JUMP},
+    {"underflow", {VM_OP_PUSH8, 1, VM_OP_ADD}, VM_ERR_STACK},
+    {"depth mismatch", {VM_OP_PUSH8, 0, VM_OP_JZ, 2, VM_OP_PUSH8, 1, VM_OP_PUSH8, 2}, VM_ERR_STACK},
+    {"two results", {VM_OP_PUSH8, 1, VM_OP_PUSH8, 2}, VM_ERR_STACK},
+    {"bad local", {VM_OP_LOAD, VM_LOCALS}, VM_ERR_LOCAL},
+};
+
+/*------------------------------ Private Functions ---------------------------*/
+
+static std::vector<uint8_t> make_image(const std::vector<uint8_t> &body)
+{
+    std::vector<uint8_t> image(VM_HEADER_SIZE + body.size());
+    const uint8_t header[VM_HEADER_SIZE] = {'V', 'M', VM_VERSION, 0, 0, 0, (uint8_t)body.size(), 0};
+    memcpy(image.data(), header, sizeof(header));
+    memcpy(&image[VM_HEADER_SIZE], body.data(), body.size());
+    return image;
+}
+
+static uint32_t check_verifier(void)
+{
+    uint32_t failures = 0;
+    vm_program_t prog;
+
+    for (const auto &c : m_cases)
+    {
+        std::vector<uint8_t> image = make_image(c.body);
+        vm_result_t result = vm_verify(image.data(), image.size(), &prog);
+        if (result != c.expected)
+        {
+            printf("verify %-22s FAIL: %s, expected %s\n", c.name, vm_result_str(result), vm_result_str(c.expected));
+            failures++;
+        }
+    }
+
+    // Every cut-short image is caught by its lengths
+    for (unsigned int length = 0; length < vm_rainbow_length; length++)
+    {
+        if (vm_verify(vm_rainbow, length, &prog) == VM_OK)
+        {
+            printf("verify truncated image FAIL: %u bytes accepted\n", length);
+            failures++;
+        }
+    }
+
+    return failures;
+}
+
+static uint32_t check_interpreter(void)
+{
+    uint32_t failures = 0;
+    vm_program_t prog;
+    uint8_t pixels[VM_CHECK_LEDS * 3];
+    leds_frame_t frame = {0, 0, m_colours};
+
+    // Even pixels (index 0 included) are black, odd ones the command colour
+    std::vector<uint8_t> image = make_image({VM_OP_INDEX, VM_OP_PUSH8, 1, VM_OP_AND, VM_OP_JZ, 3,
+                                             VM_OP_COLOUR, VM_OP_JMP, 2, VM_OP_PUSH8, 0});
+    vm_verify(image.data(), image.size(), &prog);
+    bool truncated;
+    vm_run(&prog, &frame, pixels, VM_CHECK_LEDS, VM_FRAME_BUDGET, &truncated);
+    failures += truncated;
+    for (int i = 0; i < VM_CHECK_LEDS; i++)
+    {
+        for (int c = 0; c < 3; c++)
+            failures += pixels[i * 3 + c] != ((i & 1) ? m_colours[c] : 0);
+    }
+
+    // The budget stops whole pixels, never part way through one, and a
+    // frame that only just fits isn't reported as cut short
+    vm_verify(vm_rainbow, vm_rainbow_length, &prog);
+    uint32_t budget = 1000;
+    uint32_t ops = vm_run(&prog, &frame, pixels, VM_CHECK_LEDS, budget, &truncated);
+    failures += ops > budget || !truncated;
+
+    ops = vm_run(&prog, &frame, pixels, VM_CHECK_LEDS, UINT32_MAX, &truncated);
+    vm_run(&prog, &frame, pixels, VM_CHECK_LEDS, ops + prog.body_length - 1, &truncated);
+    failures += truncated;
+
+    printf("interpreter %s\n", failures ? "FAIL" : "OK");
+    return failures;
+}
+
+// What VM_FRAME_BUDGET costs here. The ESP8266 is far slower, so this is for
+// scaling from the host, not a target figure
+static void report_rate(const vm_program_t *prog)
+{
+    uint8_t pixels[VM_CHECK_LEDS * 3];
+    leds_frame_t frame = {0, 0, m_colours};
+    bool truncated;
+    uint64_t ops = 0;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (uint32_t f = 0; f < VM_RATE_FRAMES; f++, frame.t += 20)
+        ops += vm_run(prog, &frame, pixels, VM_CHECK_LEDS, UINT32_MAX, &truncated);
+    auto t1 = std::chrono::steady_clock::now();
+
+    double rate = ops / std::chrono::duration<double, std::micro>(t1 - t0).count();
+    printf("Rainbow: %u ops/pixel, %.0f ops/us; the budget of %u ops is %u pixels, %.0f us\n",
+           (unsigned)(ops / ((uint64_t)VM_RATE_FRAMES * VM_CHECK_LEDS)), rate, VM_FRAME_BUDGET,
+           (unsigned)(VM_FRAME_BUDGET * (uint64_t)VM_RATE_FRAMES * VM_CHECK_LEDS / ops), VM_FRAME_BUDGET / rate);
+}
+
+/*------------------------------- Public Functions ---------------------------*/
+
+int vm_main(int argc, char **argv)
+{
+    uint32_t failures = check_verifier() + check_interpreter();
+    if (failures)
+        return 1;
+
+    vm_program_t prog;
+    vm_verify(vm_rainbow, vm_rainbow_length, &prog);
+    report_rate(&prog);
+
+    bench_options_t opts;
+    if (!bench_parse_options(opts, argc, argv))
+        return 1;
+
+    leds_config_t cfg;
+    leds_default_config(&cfg);
+    leds_initialise(&cfg);
+    vm_install(&prog);
+
+    for (uint16_t n : opts.lengths)
+    {
+        cfg.strips[0].length = n;
+        leds_configure(&cfg);
+
+        bench_measure(opts, "Rainbow (native)", n,
+                      []() {
+                          leds_frame_t frame = {millis(), 0, m_colours};
+                          patterns_render(PATTERN_RAINBOW, &frame);
+                      });
+
+        // Frames that could hit the budget are cut short, which would flatter it
+        if (n * (uint32_t)prog.body_length > VM_FRAME_BUDGET)
+            continue;
+
+        bench_measure(opts, "Rainbow (vm)", n,
+                      []() {
+                          leds_frame_t frame = {millis(), 0, m_colours};
+                          patterns_render(PATTERN_CUSTOM, &frame);
+                      });
+    }
+
+    return 0;
+}
+
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,283 @@
+/**
+ * @file audio.cpp
+ * @author James Bennion-Pedley
+ * @brief Fixed-point spectrum, band energy and beat detection for Music mode
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include "audio.h"
+
+/*---------------------------- Macros & Constants ----------------------------*/
+
+#define AUDIO_BINS (AUDIO_BLOCK / 2)
+
+// Samples are centred then scaled up to use the FFT's 16 bits
+#define AUDIO_INPUT_SHIFT 5
+
+// Peaks fall by 1/128 of themselves a block (a few seconds to adapt), and
+// never below a floor per bin that keeps ADC noise from being turned up
+#define AUDIO_PEAK_DECAY 7
+#define AUDIO_NOISE_FLOOR 24
+
+// A beat is the bass jumping well clear of its recent average and spread.
+// Averages move 1/8 of the way each block (about 250 ms to settle); beats
+// are at least 9 blocks (288 ms, 208 BPM) apart
+#define AUDIO_AVERAGE_SHIFT 3
+#define AUDIO_BEAT_HOLDOFF 9
+
+/*----------------------------------- State ----------------------------------*/
+
+// Filled by the sampler, emptied a block at a time by polls
+static uint16_t m_ring[AUDIO_RING];
+static uint16_t m_head = 0;
+static uint16_t m_tail = 0;
+static uint32_t m_overflows = 0;
+static uint16_t m_last = 512; // Latest reading, for filling gaps; mid-scale at first
+
+// First bin of each band, then one past the last bin of the last band
+static const uint8_t m_band_start[AUDIO_BANDS + 1] = {1, 4, 12, 24, AUDIO_BINS};
+
+// What the analysis has learnt about the input
+static uint32_t m_peak[AUDIO_BANDS + 1]; // The last is the total
+static uint32_t m_bass_average = 0;
+static uint32_t m_bass_spread = 0;
+static uint32_t m_since_beat = 0;
+
+static audio_features_t m_features;
+
+// sin16() from FastLED's C implementation, which the tables are built from
+// at compile time so they match what patterns see
+static constexpr int16_t sin16_c(uint16_t theta)
+{
+    const uint16_t base[] = {0, 6393, 12539, 18204, 23170, 27245, 30273, 32137};
+    const uint8_t slope[] = {49, 48, 44, 38, 31, 23, 14, 4};
+
+    uint16_t offset = (theta & 0x3FFF) >> 3;
+    if (theta & 0x4000)
+        offset = 2047 - offset;
+
+    uint8_t section = offset / 256;
+    uint8_t secoffset8 = (uint8_t)offset / 2;
+    int16_t y = slope[section] * secoffset8 + base[section];
+    return (theta & 0x8000) ? -y : y;
+}
+
+typedef struct
+{
+    int16_t cos[AUDIO_BINS]; // Twiddle factors, Q15
+    int16_t sin[AUDIO_BINS];
+    int16_t window[AUDIO_BLOCK]; // Hann, Q15
+    uint8_t reverse[AUDIO_BLOCK]; // Bit-reversed index of each sample
+} audio_tables_t;
+
+static constexpr audio_tables_t make_audio_tables(void)
+{
+    audio_tables_t t = {};
+    for (uint16_t k = 0; k < AUDIO_BINS; k++)
+    {
+        t.cos[k] = sin16_c(k * (65536 / AUDIO_BLOCK) + 16384);
+        t.sin[k] = sin16_c(k * (65536 / AUDIO_BLOCK));
+    }
+    for (uint16_t i = 0; i < AUDIO_BLOCK; i++)
+    {
+        t.window[i] = (32767 - sin16_c(i * (65536 / AUDIO_BLOCK) + 16384)) / 2;
+
+        uint8_t r = 0;
+        for (uint8_t bit = 0; bit < AUDIO_BLOCK_BITS; bit++)
+            r |= ((i >> bit) & 1) << (AUDIO_BLOCK_BITS - 1 - bit);
+        t.reverse[i] = r;
+    }
+    return t;
+}
+
+static constexpr audio_tables_t m_tables = make_audio_tables();
+
+/*------------------------------ Private Functions ---------------------------*/
+
+// In-place radix-2, halving at each stage so it can't overflow; the result
+// is the spectrum divided by AUDIO_BLOCK
+static void fft(int16_t *re, int16_t *im)
+{
+    for (uint16_t len = 2, step = AUDIO_BINS; len <= AUDIO_BLOCK; len <<= 1, step >>= 1)
+    {
+        uint16_t half = len >> 1;
+        for (uint16_t i = 0; i < AUDIO_BLOCK; i += len)
+        {
+            for (uint16_t j = 0; j < half; j++)
+            {
+                int32_t wr = m_tables.cos[j * step];
+                int32_t wi = -m_tables.sin[j * step];
+                uint16_t a = i + j, b = a + half;
+
+                int32_t tr = (re[b] * wr - im[b] * wi) >> 15;
+                int32_t ti = (re[b] * wi + im[b] * wr) >> 15;
+                re[b] = (re[a] - tr) >> 1;
+                im[b] = (im[a] - ti) >> 1;
+                re[a] = (re[a] + tr) >> 1;
+                im[a] = (im[a] + ti) >> 1;
+            }
+        }
+    }
+}
+
+// Alpha max plus beta min: within 7% of the true magnitude, no square root
+static inline uint16_t magnitude(int16_t re, int16_t im)
+{
+    uint16_t a = (re < 0) ? -re : re;
+    uint16_t b = (im < 0) ? -im : im;
+    return (a > b) ? a + ((3 * b) >> 3) : b + ((3 * a) >> 3);
+}
+
+// How loud this is against the loudest it's been lately
+static uint8_t normalise(uint32_t energy, uint32_t &peak, uint32_t floor)
+{
+    if (energy > peak)
+        peak = energy;
+    else
+        peak -= peak >> AUDIO_PEAK_DECAY;
+    if (peak < floor)
+        peak = floor;
+
+    return (energy >= peak) ? 255 : (energy * 255) / peak;
+}
+
+static void detect_beat(uint32_t bass)
+{
+    m_since_beat++;
+
+    uint32_t threshold = m_bass_average + 2 * m_bass_spread;
+    if (threshold < m_bass_average + (m_bass_average >> 2))
+        threshold = m_bass_average + (m_bass_average >> 2);
+
+    uint32_t floor = AUDIO_NOISE_FLOOR * (m_band_start[1] - m_band_start[0]);
+    if (bass > threshold && bass > floor && m_since_beat >= AUDIO_BEAT_HOLDOFF)
+    {
+        m_features.beats++;
+        m_since_beat = 0;
+    }
+
+    uint32_t spread = (bass > m_bass_average) ? bass - m_bass_average : m_bass_average - bass;
+    m_bass_average = m_bass_average + (bass >> AUDIO_AVERAGE_SHIFT) - (m_bass_average >> AUDIO_AVERAGE_SHIFT);
+    m_bass_spread = m_bass_spread + (spread >> AUDIO_AVERAGE_SHIFT) - (m_bass_spread >> AUDIO_AVERAGE_SHIFT);
+}
+
+/*------------------------------- Public Functions ---------------------------*/
+
+void audio_reset(void)
+{
+    // Only the consumer's side moves, so the sampler can keep pushing
+    m_tail = m_head;
+    m_overflows = 0;
+
+    memset(m_peak, 0, sizeof(m_peak));
+    m_bass_average = 0;
+    m_bass_spread = 0;
+    m_since_beat = AUDIO_BEAT_HOLDOFF;
+    memset(&m_features, 0, sizeof(m_features));
+}
+
+void audio_push(uint16_t sample)
+{
+    uint16_t head = m_head;
+    if ((uint16_t)(head - m_tail) >= AUDIO_RING)
+    {
+        m_overflows++;
+        return;
+    }
+
+    m_ring[head & (AUDIO_RING - 1)] = sample;
+    m_head = head + 1;
+    m_last = sample;
+}
+
+void audio_push_late(uint16_t sample, uint16_t count)
+{
+    int32_t from = m_last;
+    for (uint16_t i = 1; i < count; i++)
+        audio_push(from + ((int32_t)(sample - from) * i) / count);
+    audio_push(sample);
+}
+
+uint32_t audio_poll(void)
+{
+    uint32_t count = 0;
+    uint16_t block[AUDIO_BLOCK];
+
+    while ((uint16_t)(m_head - m_tail) >= AUDIO_BLOCK)
+    {
+        uint16_t tail = m_tail;
+        for (uint16_t i = 0; i < AUDIO_BLOCK; i++)
+            block[i] = m_ring[(tail + i) & (AUDIO_RING - 1)];
+        m_tail = tail + AUDIO_BLOCK;
+
+        audio_analyse(block);
+        count++;
+    }
+
+    m_features.overflows = m_overflows;
+    return count;
+}
+
+void audio_analyse(const uint16_t *block)
+{
+    // Centre on the block's own mean, so the microphone's bias drops out
+    uint32_t sum = 0;
+    for (uint16_t i = 0; i < AUDIO_BLOCK; i++)
+        sum += block[i];
+    int16_t mean = sum >> AUDIO_BLOCK_BITS;
+
+    int16_t re[AUDIO_BLOCK], im[AUDIO_BLOCK];
+    for (uint16_t i = 0; i < AUDIO_BLOCK; i++)
+    {
+        int32_t x = (int32_t)(block[i] - mean) << AUDIO_INPUT_SHIFT;
+        uint8_t r = m_tables.reverse[i];
+        re[r] = (x * m_tables.window[i]) >> 15;
+        im[r] = 0;
+    }
+
+    fft(re, im);
+
+    // Bin 0 is what's left of the bias, and the top half mirrors the bottom
+    uint32_t bands[AUDIO_BANDS + 1] = {};
+    uint64_t moment = 0;
+    for (uint8_t band = 0; band < AUDIO_BANDS; band++)
+    {
+        for (uint8_t k = m_band_start[band]; k < m_band_start[band + 1]; k++)
+        {
+            uint16_t m = magnitude(re[k], im[k]);
+            bands[band] += m;
+            moment += (uint32_t)m * k;
+        }
+        bands[AUDIO_BANDS] += bands[band];
+    }
+
+    for (uint8_t band = 0; band < AUDIO_BANDS; band++)
+    {
+        uint32_t floor = AUDIO_NOISE_FLOOR * (m_band_start[band + 1] - m_band_start[band]);
+        m_features.bands[band] = normalise(bands[band], m_peak[band], floor);
+    }
+    m_features.level = normalise(bands[AUDIO_BANDS], m_peak[AUDIO_BANDS], AUDIO_NOISE_FLOOR * (AUDIO_BINS - 1));
+
+    // Mean bin, weighted by magnitude, from the first bin to the last
+    uint32_t total = bands[AUDIO_BANDS];
+    if (total > 0)
+    {
+        uint32_t centre = (moment << 8) / total; // Bins, 8.8 fixed point
+        m_features.centroid = ((centre - 256) * 255) / ((AUDIO_BINS - 2) * 256);
+    }
+
+    detect_beat(bands[0]);
+    m_features.blocks++;
+}
+
+const audio_features_t *audio_get_features(void)
+{
+    return &m_features;
+}
+
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,64 @@
+/**
+ * @file audio.h
+ * @author James Bennion-Pedley
+ * @brief Fixed-point spectrum, band energy and beat detection for Music mode
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef __FIRMWARE_SRC_AUDIO_H__
+#define __FIRMWARE_SRC_AUDIO_H__
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <Arduino.h>
+
+/*---------------------------- Macros & Constants ----------------------------*/
+
+// A0 is sampled at this rate, and analysed a block at a time. 64 samples
+// at 2 kHz is a 32 ms block with 31.25 Hz bins, from 31 Hz to 1 kHz
+#define AUDIO_SAMPLE_HZ 2000
+#define AUDIO_BLOCK 64
+#define AUDIO_BLOCK_BITS 6
+#define AUDIO_RING 512 // Samples buffered between polls: 256 ms
+
+// Bass, low mids, high mids, highs; beats are found in the bass
+#define AUDIO_BANDS 4
+
+/*--------------------------------- Datatypes --------------------------------*/
+
+typedef struct
+{
+    uint8_t bands[AUDIO_BANDS]; // Energy in each band, against its recent peak
+    uint8_t level;              // All bands together, the same way
+    uint8_t centroid;           // Where the energy sits, 0 (31 Hz) to 255 (1 kHz)
+    uint32_t beats;             // Beats detected since the last reset
+    uint32_t blocks;            // Blocks analysed since the last reset
+    uint32_t overflows;         // Samples lost because polls fell behind
+} audio_features_t;
+
+/*--------------------------------- Functions --------------------------------*/
+
+// Drops buffered samples and everything learnt about the input so far
+void audio_reset(void);
+
+// Raw 10-bit ADC reading, one per sample time
+void audio_push(uint16_t sample);
+
+// A reading taken count sample times after the last one; the times missed
+// in between are filled in on a straight line from that one
+void audio_push_late(uint16_t sample, uint16_t count);
+
+// Analyses every complete block waiting in the ring; returns how many
+uint32_t audio_poll(void);
+
+// One block of raw samples straight through the analysis, skipping the ring
+void audio_analyse(const uint16_t *block);
+
+const audio_features_t *audio_get_features(void);
+
+/*----------------------------------------------------------------------------*/
+
+#endif /* __FIRMWARE_SRC_AUDIO_H__ */
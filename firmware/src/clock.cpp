@@ -0,0 +1,107 @@
+/**
+ * @file clock.cpp
+ * @author James Bennion-Pedley
+ * @brief Animation clock shared by every light on the broker
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <Arduino.h>
+
+#include "clock.h"
+
+/*----------------------------------- State ----------------------------------*/
+
+static uint32_t m_offset = 0; // Shared time minus millis()
+static clock_stats_t m_stats;
+
+/*------------------------------ Private Functions ---------------------------*/
+
+static uint32_t next_random(clock_beacon_t *b, uint32_t range)
+{
+    b->random ^= b->random << 13;
+    b->random ^= b->random >> 17;
+    b->random ^= b->random << 5;
+    return b->random % range;
+}
+
+// Somewhere in the second half of the next period
+static void schedule(clock_beacon_t *b, uint32_t t_now)
+{
+    b->t_next = t_now + CLOCK_BEACON_MS / 2 + next_random(b, CLOCK_BEACON_MS / 2);
+}
+
+/*------------------------------- Public Functions ---------------------------*/
+
+uint32_t clock_now(void)
+{
+    return millis() + m_offset;
+}
+
+int32_t clock_sync(uint32_t remote)
+{
+    // Every light follows the furthest-ahead clock it hears. A timestamp is at
+    // least one broker hop old when it arrives, so it can only ever be behind
+    // that clock: the estimate never overshoots, and only moves forwards, so
+    // patterns never run backwards. Lights end up within the fastest one-way
+    // broker delay of each other, which is a few ms on a local broker.
+    m_stats.samples++;
+
+    int32_t ahead = remote - clock_now();
+    if (ahead <= 0)
+        return ahead;
+
+    m_offset += ahead;
+    m_stats.adjustments++;
+    m_stats.last_step = ahead;
+    return ahead;
+}
+
+const clock_stats_t *clock_get_stats(void)
+{
+    return &m_stats;
+}
+
+void clock_beacon_start(clock_beacon_t *b, uint32_t t_now, uint32_t seed)
+{
+    b->random = seed | 1;
+    b->nonce = next_random(b, 0x10000);
+    schedule(b, t_now);
+}
+
+bool clock_beacon_due(clock_beacon_t *b, uint32_t t_now)
+{
+    if ((int32_t)(t_now - b->t_next) < 0)
+        return false;
+
+    b->nonce = next_random(b, 0x10000);
+    schedule(b, t_now);
+    return true;
+}
+
+void clock_beacon_heard(clock_beacon_t *b, uint32_t t_now, int32_t ahead, uint16_t nonce)
+{
+    // The broker sends our own back; that says nothing about anyone else
+    if (nonce == b->nonce)
+        return;
+
+    // Someone in step spoke for us. Everyone who heard it starts a fresh
+    // period, so a room sends about one beacon a period, not one per light
+    if (ahead >= -CLOCK_IN_STEP_MS)
+    {
+        schedule(b, t_now);
+        return;
+    }
+
+    // The sender is behind. Answer within the first eighth of a period; the
+    // first answer to arrive is in step for the others, who then stay quiet
+    uint32_t t_answer = t_now + next_random(b, CLOCK_BEACON_MS / 8);
+    if ((int32_t)(t_answer - b->t_next) < 0)
+        b->t_next = t_answer;
+}
+
+/*----------------------------------------------------------------------------*/
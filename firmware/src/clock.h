@@ -0,0 +1,67 @@
+/**
+ * @file clock.h
+ * @author James Bennion-Pedley
+ * @brief Animation clock shared by every light on the broker
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef __FIRMWARE_SRC_CLOCK_H__
+#define __FIRMWARE_SRC_CLOCK_H__
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <stdint.h>
+
+/*---------------------------- Macros & Constants ----------------------------*/
+
+// A room sends about one beacon this often, whatever its size
+#define CLOCK_BEACON_MS 2000
+
+// Beacons up to this far behind our clock are in step (a broker hop old)
+#define CLOCK_IN_STEP_MS 100
+
+/*--------------------------------- Datatypes --------------------------------*/
+
+typedef struct
+{
+    uint32_t samples;     // Timestamps heard from other lights
+    uint32_t adjustments; // Samples that moved the clock forward
+    uint32_t last_step;   // Size of the latest adjustment, ms
+} clock_stats_t;
+
+// When a light next stamps the clock topic. Each waits a random part of a
+// period, and stays quiet if it hears a beacon in step with it first; one
+// that hears a clock behind its own answers soon, to pull it forward
+typedef struct
+{
+    uint32_t t_next; // ms
+    uint32_t random; // xorshift state
+    uint16_t nonce;  // Sequence number of our last beacon, to spot its echo
+} clock_beacon_t;
+
+/*--------------------------------- Functions --------------------------------*/
+
+// Shared time in ms; wraps every ~49 days like millis()
+uint32_t clock_now(void);
+
+// Feed a timestamp another light stamped with its clock_now() when sending;
+// returns how far ahead of ours it was, before following it
+int32_t clock_sync(uint32_t remote);
+
+const clock_stats_t *clock_get_stats(void);
+
+// Times are millis(); the seed only needs to differ between lights
+void clock_beacon_start(clock_beacon_t *b, uint32_t t_now, uint32_t seed);
+
+// True when a beacon is due, stamped with b->nonce as its sequence number
+bool clock_beacon_due(clock_beacon_t *b, uint32_t t_now);
+
+// A beacon off the clock topic, and what clock_sync() said of its time
+void clock_beacon_heard(clock_beacon_t *b, uint32_t t_now, int32_t ahead, uint16_t nonce);
+
+/*----------------------------------------------------------------------------*/
+
+#endif /* __FIRMWARE_SRC_CLOCK_H__ */
@@ -0,0 +1,95 @@
+/**
+ * @file commands.cpp
+ * @author James Bennion-Pedley
+ * @brief Queue of parsed commands, applied between frames
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <string.h>
+
+#include "commands.h"
+
+/*---------------------------- Macros & Constants ----------------------------*/
+
+#define COMMANDS_MASK (COMMANDS_QUEUE_SIZE - 1)
+
+// Fields whose effect doesn't depend on anything applied before them
+#define COMMANDS_REPLACEABLE (PROTOCOL_HAS_MODE | PROTOCOL_HAS_COLOUR | PROTOCOL_HAS_OVERRIDE | \
+                              PROTOCOL_HAS_TIME | PROTOCOL_HAS_SEED | PROTOCOL_HAS_METRICS | \
+                              PROTOCOL_HAS_FADE | PROTOCOL_HAS_PROGRAM | PROTOCOL_HAS_LAYOUT)
+
+/*----------------------------------- State ----------------------------------*/
+
+static protocol_command_t m_queue[COMMANDS_QUEUE_SIZE];
+static uint8_t m_head = 0; // Next to pop
+static uint8_t m_tail = 0; // Next free slot
+static commands_stats_t m_stats;
+
+/*------------------------------ Private Functions ---------------------------*/
+
+static uint8_t queued(void)
+{
+    return (uint8_t)(m_tail - m_head);
+}
+
+static bool replaces(const protocol_command_t *older, const protocol_command_t *newer)
+{
+    // Applying both has to leave the same state as applying the newer alone
+    if (older->fields != newer->fields || (newer->fields & ~COMMANDS_REPLACEABLE))
+        return false;
+
+    // A lock ahead of the mode change would decide whether the older one lands
+    if ((newer->fields & PROTOCOL_HAS_OVERRIDE) && (newer->fields & PROTOCOL_HAS_MODE))
+        return false;
+
+    return !(newer->fields & PROTOCOL_HAS_MODE) || older->mode == newer->mode;
+}
+
+/*------------------------------- Public Functions ---------------------------*/
+
+void commands_push(const protocol_command_t *cmd)
+{
+    m_stats.received++;
+
+    if (queued() > 0)
+    {
+        protocol_command_t *last = &m_queue[(m_tail - 1) & COMMANDS_MASK];
+        if (replaces(last, cmd))
+        {
+            *last = *cmd;
+            m_stats.coalesced++;
+            return;
+        }
+    }
+
+    if (queued() == COMMANDS_QUEUE_SIZE)
+    {
+        m_head++;
+        m_stats.dropped++;
+    }
+
+    m_queue[m_tail & COMMANDS_MASK] = *cmd;
+    m_tail++;
+}
+
+bool commands_pop(protocol_command_t *cmd)
+{
+    if (queued() == 0)
+        return false;
+
+    *cmd = m_queue[m_head & COMMANDS_MASK];
+    m_head++;
+    return true;
+}
+
+const commands_stats_t *commands_get_stats(void)
+{
+    return &m_stats;
+}
+
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,44 @@
+/**
+ * @file commands.h
+ * @author James Bennion-Pedley
+ * @brief Queue of parsed commands, applied between frames
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef __FIRMWARE_SRC_COMMANDS_H__
+#define __FIRMWARE_SRC_COMMANDS_H__
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <stdint.h>
+
+#include "protocol.h"
+
+/*---------------------------- Macros & Constants ----------------------------*/
+
+#define COMMANDS_QUEUE_SIZE 8 // Power of two
+
+/*--------------------------------- Datatypes --------------------------------*/
+
+typedef struct
+{
+    uint32_t received;  // Commands queued
+    uint32_t coalesced; // Replaced by a newer one before being applied
+    uint32_t dropped;   // Pushed out of a full queue
+} commands_stats_t;
+
+/*--------------------------------- Functions --------------------------------*/
+
+// A command with the same shape as the last queued one replaces it, so a
+// burst of colour-picker drags costs one apply. When full, the oldest goes
+void commands_push(const protocol_command_t *cmd);
+bool commands_pop(protocol_command_t *cmd);
+
+const commands_stats_t *commands_get_stats(void);
+
+/*----------------------------------------------------------------------------*/
+
+#endif /* __FIRMWARE_SRC_COMMANDS_H__ */
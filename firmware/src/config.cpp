@@ -0,0 +1,202 @@
+/**
+ * @file config.cpp
+ * @author James Bennion-Pedley
+ * @brief Persistent configuration, loaded once at boot
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <Arduino.h>
+
+#include <LittleFS.h>
+
+#include "config.h"
+#include "sampler.h"
+
+/*---------------------------- Macros & Constants ----------------------------*/
+
+#define CONFIG_MAGIC 0x4C474843 // "CHGL"
+#define CONFIG_VERSION 1
+
+// Quiet time before a change is written
+#define CONFIG_WRITE_DELAY_MS 5000
+
+// Records alternate between two files. A write that's cut short only ever
+// damages the older one, and the CRC catches it at the next boot
+static const char *m_slots[2] = {"/config.0", "/config.1"};
+
+// Files used before the config record existed, migrated on first boot
+static const char *m_legacy_ssid = "/ssid.txt";
+static const char *m_legacy_psk = "/psk.txt";
+
+/*--------------------------------- Datatypes --------------------------------*/
+
+typedef struct
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t length;     // sizeof(config_t) when written
+    uint32_t generation; // Highest valid generation wins
+    uint32_t crc;        // CRC-32 of the config that follows
+} config_header_t;
+
+/*----------------------------------- State ----------------------------------*/
+
+static config_t m_config;
+static uint32_t m_generation = 0;
+static uint8_t m_slot = 1; // Slot holding the current record
+
+static bool m_dirty = false;
+static uint32_t m_t_dirty = 0;
+
+/*------------------------------ Private Functions ---------------------------*/
+
+static uint32_t crc32(const uint8_t *data, size_t len)
+{
+    uint32_t crc = 0xFFFFFFFF;
+    while (len--)
+    {
+        crc ^= *data++;
+        for (uint8_t i = 0; i < 8; i++)
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+    }
+
+    return ~crc;
+}
+
+static bool read_slot(uint8_t slot, config_t *cfg, uint32_t *generation)
+{
+    File f = LittleFS.open(m_slots[slot], "r");
+    if (!f)
+        return false;
+
+    // Shorter records predate fields added on the end, which stay zeroed
+    memset(cfg, 0, sizeof(*cfg));
+
+    config_header_t header;
+    bool ok = f.read((uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+              header.magic == CONFIG_MAGIC && header.version == CONFIG_VERSION &&
+              header.length <= sizeof(*cfg) &&
+              f.read((uint8_t *)cfg, header.length) == header.length &&
+              crc32((const uint8_t *)cfg, header.length) == header.crc;
+    f.close();
+
+    if (ok)
+        *generation = header.generation;
+    return ok;
+}
+
+static bool write_slot(void)
+{
+    uint8_t slot = m_slot ^ 1;
+
+    config_header_t header;
+    header.magic = CONFIG_MAGIC;
+    header.version = CONFIG_VERSION;
+    header.length = sizeof(m_config);
+    header.generation = m_generation + 1;
+    header.crc = crc32((const uint8_t *)&m_config, sizeof(m_config));
+
+    sampler_pause(true);
+    File f = LittleFS.open(m_slots[slot], "w");
+    bool ok = f && f.write((const uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+              f.write((const uint8_t *)&m_config, sizeof(m_config)) == sizeof(m_config);
+    if (f)
+    {
+        f.flush();
+        f.close();
+    }
+    sampler_pause(false);
+
+    if (ok)
+    {
+        m_generation = header.generation;
+        m_slot = slot;
+    }
+
+    return ok;
+}
+
+static void read_legacy_string(const char *path, char *dest, size_t size)
+{
+    File f = LittleFS.open(path, "r");
+    if (!f)
+        return;
+
+    size_t n = f.readBytes(dest, size - 1);
+    dest[n] = '\0';
+    f.close();
+}
+
+static void migrate_legacy(void)
+{
+    read_legacy_string(m_legacy_ssid, m_config.ssid, sizeof(m_config.ssid));
+    read_legacy_string(m_legacy_psk, m_config.psk, sizeof(m_config.psk));
+}
+
+/*------------------------------- Public Functions ---------------------------*/
+
+void config_initialise(void)
+{
+    config_t slot_cfg[2];
+    uint32_t generation[2];
+    bool valid[2];
+
+    for (uint8_t i = 0; i < 2; i++)
+        valid[i] = read_slot(i, &slot_cfg[i], &generation[i]);
+
+    if (valid[0] || valid[1])
+    {
+        // Generations only go up, so the newer one is ahead (modulo wrap)
+        uint8_t newest = (valid[0] && valid[1]) ? ((int32_t)(generation[1] - generation[0]) > 0)
+                                                : valid[1];
+        m_config = slot_cfg[newest];
+        m_generation = generation[newest];
+        m_slot = newest;
+        return;
+    }
+
+    memset(&m_config, 0, sizeof(m_config));
+    migrate_legacy();
+    if (!write_slot())
+        return;
+
+    LittleFS.remove(m_legacy_ssid);
+    LittleFS.remove(m_legacy_psk);
+}
+
+void config_loop(uint32_t t_now)
+{
+    if (m_dirty && (t_now - m_t_dirty) > CONFIG_WRITE_DELAY_MS)
+        config_flush();
+}
+
+const config_t *config_get(void)
+{
+    return &m_config;
+}
+
+void config_set(const config_t *cfg)
+{
+    if (!memcmp(cfg, &m_config, sizeof(m_config)))
+        return;
+
+    m_config = *cfg;
+    m_dirty = true;
+    m_t_dirty = millis();
+}
+
+void config_flush(void)
+{
+    if (!m_dirty)
+        return;
+
+    write_slot();
+    m_dirty = false;
+}
+
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,95 @@
+/**
+ * @file config.h
+ * @author James Bennion-Pedley
+ * @brief Persistent configuration, loaded once at boot
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef __FIRMWARE_SRC_CONFIG_H__
+#define __FIRMWARE_SRC_CONFIG_H__
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <stdint.h>
+
+#include "layout.h"
+#include "leds.h"
+#include "protocol.h"
+
+/*---------------------------- Macros & Constants ----------------------------*/
+
+#define CONFIG_SSID_SIZE 33 // 32 characters, plus terminator
+#define CONFIG_PSK_SIZE 65  // 64 characters, plus terminator
+
+/*--------------------------------- Datatypes --------------------------------*/
+
+// New fields go on the end: records written before they existed still load,
+// with them zeroed. Anything else means bumping CONFIG_VERSION in config.cpp
+typedef struct
+{
+    // WiFi credentials from the portal; empty means use the built-in ones
+    char ssid[CONFIG_SSID_SIZE];
+    char psk[CONFIG_PSK_SIZE];
+
+    // Strip layout; a count of 0 means use the default
+    leds_config_t strips;
+
+    // Last show, restored at power-up
+    bool has_state;
+    uint8_t mode; // pattern_id_t
+    uint8_t colour[3];
+    bool enable;
+    bool lock;
+    uint32_t seed;
+
+    // Last access point and DHCP lease, to rejoin without a scan or DHCP
+    bool has_wifi_cache;
+    uint8_t bssid[6];
+    uint8_t channel;
+    uint32_t ip;
+    uint32_t gateway;
+    uint32_t subnet;
+    uint32_t dns;
+
+    // Metrics snapshot period, s (0 = off)
+    uint16_t metrics_s;
+
+    // Groups we take commands on, besides the room and our own topic
+    uint8_t group_count;
+    char groups[PROTOCOL_MAX_GROUPS][PROTOCOL_GROUP_SIZE];
+
+    // Crossfade time between looks, ms; the default until one is set
+    bool has_fade;
+    uint16_t fade_ms;
+
+    // Program the Custom pattern runs, empty for none
+    char program[PROTOCOL_PROGRAM_SIZE];
+
+    // How the pixels are arranged, for 2D patterns; zeroed is a strip
+    layout_config_t layout;
+
+    // The cached lease's length, s, and Unix time it was granted (0 = not
+    // known), so a light stops reusing it before it runs out
+    uint32_t lease_s;
+    uint32_t lease_bound;
+} config_t;
+
+/*--------------------------------- Functions --------------------------------*/
+
+// Needs LittleFS mounted
+void config_initialise(void);
+void config_loop(uint32_t t_now);
+
+const config_t *config_get(void);
+
+// Changes are written a few seconds later, so bursts cost one flash write.
+// Flush before restarting to make sure they've landed
+void config_set(const config_t *cfg);
+void config_flush(void);
+
+/*----------------------------------------------------------------------------*/
+
+#endif /* __FIRMWARE_SRC_CONFIG_H__ */
@@ -0,0 +1,402 @@
+/**
+ * @file connection.cpp
+ * @author James Bennion-Pedley
+ * @brief Non-blocking WiFi and MQTT connection manager
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <Arduino.h>
+
+#include <ESP8266WiFi.h>
+#include <PubSubClient.h>
+#include <lwip/dhcp.h>
+#include <time.h>
+
+#include "config.h"
+#include "connection.h"
+#include "metrics.h"
+#include "server.h"
+
+/*---------------------------- Macros & Constants ----------------------------*/
+
+#define CONNECTION_WIFI_TIMEOUT 20000 // Before falling back to the portal
+#define CONNECTION_FAST_TIMEOUT 3000  // Before giving up on the cached AP
+#define CONNECTION_BACKOFF_MIN 2000
+#define CONNECTION_BACKOFF_MAX 60000
+#define CONNECTION_BROKER_PORT 1883
+
+// Each broker attempt blocks for up to a lookup, a TCP connect and a wait
+// for CONNACK: 2.5 s at worst, 1.5 s with the address cached
+#define CONNECTION_DNS_TIMEOUT 1000
+#define CONNECTION_CONNECT_TIMEOUT 500
+#define CONNECTION_SOCKET_TIMEOUT 1 // Seconds, PubSubClient's smallest
+#define CONNECTION_RESOLVE_AFTER 4  // Failed attempts before looking up again
+// Fixed header (up to 5 bytes with the remaining length), topic length, topic
+// and payload, so the largest publish fits
+#define CONNECTION_BUFFER_SIZE (5 + 2 + CONNECTION_TOPIC_SIZE + CONNECTION_PAYLOAD_SIZE)
+
+// Leases are dated from SNTP; anything earlier means it hasn't answered yet
+#define CONNECTION_NTP_SERVER "pool.ntp.org"
+#define CONNECTION_TIME_VALID 1600000000
+
+/*----------------------------------- State ----------------------------------*/
+
+// MQTT Broker
+static const char *m_broker = "broker.emqx.io";
+static const char *m_broker_username = "emqx";
+static const char *m_broker_password = "public";
+
+// Instances
+static WiFiClient m_espClient;
+static PubSubClient m_client(m_espClient);
+
+static connection_online_cb_t m_on_online = nullptr;
+
+static connection_state_t m_state = CONNECTION_WIFI;
+static bool m_joined = false; // Has WiFi ever connected since boot?
+static uint32_t m_t_state = 0;
+static uint32_t m_t_retry = 0;
+static uint32_t m_backoff = CONNECTION_BACKOFF_MIN;
+static uint32_t m_reconnects = 0;
+static IPAddress m_broker_ip;
+static bool m_resolved = false;
+static uint8_t m_failures = 0; // Attempts since the broker was looked up
+static bool m_fast = false; // Joining with the cached AP and lease
+static uint32_t m_t_bound = 0; // When DHCP gave us a lease this boot, ms
+static bool m_lease_checked = false;
+static connection_boot_t m_boot;
+
+static char m_client_id[40];
+static const char *m_will_topic = nullptr;
+
+/*------------------------------ Private Functions ---------------------------*/
+
+static void set_state(connection_state_t state, uint32_t t_now)
+{
+    m_state = state;
+    m_t_state = t_now;
+}
+
+static void toggle_status_led(void)
+{
+    digitalWrite(LED_BUILTIN, !digitalRead(LED_BUILTIN));
+}
+
+// Length of the lease DHCP just gave us, s; 0 if it isn't known
+static uint32_t dhcp_lease(void)
+{
+    struct dhcp *dhcp = (netif_default != nullptr) ? netif_dhcp_data(netif_default) : nullptr;
+    return (dhcp != nullptr) ? dhcp->offered_t0_lease : 0;
+}
+
+static void save_wifi_cache(bool valid)
+{
+    config_t cfg = *config_get();
+    cfg.has_wifi_cache = valid;
+    if (valid)
+    {
+        memcpy(cfg.bssid, WiFi.BSSID(), sizeof(cfg.bssid));
+        cfg.channel = WiFi.channel();
+        cfg.ip = WiFi.localIP();
+        cfg.gateway = WiFi.gatewayIP();
+        cfg.subnet = WiFi.subnetMask();
+        cfg.dns = WiFi.dnsIP();
+        cfg.lease_s = dhcp_lease();
+        cfg.lease_bound = 0; // Dated once SNTP answers
+    }
+
+    // Only actually written when something changed
+    config_set(&cfg);
+}
+
+static void begin_wifi(void)
+{
+    // After a power blip, going straight to the last access point on its
+    // channel skips the scan, and reusing the lease skips DHCP. That's most of
+    // the join time, and spares the AP a whole room asking at once
+    const config_t *cfg = config_get();
+    m_fast = cfg->has_wifi_cache;
+    if (m_fast)
+    {
+        WiFi.config(IPAddress(cfg->ip), IPAddress(cfg->gateway), IPAddress(cfg->subnet), IPAddress(cfg->dns));
+        WiFi.begin(server_get_ssid(), server_get_psk(), cfg->channel, cfg->bssid);
+    }
+    else
+    {
+        WiFi.begin(server_get_ssid(), server_get_psk());
+    }
+}
+
+// The AP moved, or the lease may no longer be ours: scan and ask DHCP
+static void join_with_dhcp(uint32_t t_now)
+{
+    save_wifi_cache(false);
+    if (m_client.connected())
+        m_client.disconnect();
+    WiFi.disconnect();
+    WiFi.config(IPAddress((uint32_t)0), IPAddress((uint32_t)0), IPAddress((uint32_t)0));
+    begin_wifi();
+    set_state(CONNECTION_WIFI, t_now);
+}
+
+static void poll_wifi(uint32_t t_now)
+{
+    if (WiFi.status() == WL_CONNECTED)
+    {
+        Serial.printf("Connected to the WiFi network: %s\r\n", server_get_ssid());
+        if (m_boot.t_wifi == 0)
+        {
+            m_boot.t_wifi = t_now;
+            m_boot.fast = m_fast;
+        }
+
+        // A lease from DHCP (or a new AP) is worth remembering
+        if (!m_fast)
+        {
+            save_wifi_cache(true);
+            m_t_bound = t_now;
+        }
+        m_lease_checked = false;
+
+        m_joined = true;
+        m_t_retry = t_now;
+        set_state(CONNECTION_BROKER, t_now);
+        return;
+    }
+
+    if ((int32_t)(t_now - m_t_retry) >= 0)
+    {
+        Serial.println("Connecting to WiFi...");
+        toggle_status_led();
+        m_t_retry = t_now + 500;
+    }
+
+    if (m_fast && (t_now - m_t_state > CONNECTION_FAST_TIMEOUT))
+    {
+        Serial.println("Cached access point failed - scanning");
+        join_with_dhcp(t_now);
+        return;
+    }
+
+    // Only fall back to onboarding if these credentials have never worked
+    if (!m_joined && (t_now - m_t_state > CONNECTION_WIFI_TIMEOUT))
+    {
+        Serial.println("Could not connect - create soft AP");
+        server_launch_ap("GRADUATION-LIGHTS");
+        set_state(CONNECTION_PORTAL, t_now);
+    }
+}
+
+static void retry_later(uint32_t t_now)
+{
+    toggle_status_led();
+
+    // Exponential backoff, with jitter so a room of tables doesn't retry in step
+    m_t_retry = t_now + m_backoff + random(m_backoff / 4);
+    m_backoff = min((uint32_t)(m_backoff * 2), (uint32_t)CONNECTION_BACKOFF_MAX);
+}
+
+// There's no clock until SNTP answers, so a cached lease is only checked
+// after it has been used to join. It is given up at half its length, when
+// DHCP would have renewed it, or straight away if it was never dated
+static void poll_lease(uint32_t t_now)
+{
+    time_t now = time(nullptr);
+    if (m_lease_checked || now < CONNECTION_TIME_VALID)
+        return;
+    m_lease_checked = true;
+
+    config_t cfg = *config_get();
+    if (!m_fast)
+    {
+        cfg.lease_bound = now - (t_now - m_t_bound) / 1000;
+        config_set(&cfg);
+        return;
+    }
+
+    if (cfg.lease_bound == 0 || (uint32_t)(now - cfg.lease_bound) >= cfg.lease_s / 2)
+    {
+        Serial.println("Cached lease is due for renewal - asking DHCP");
+        join_with_dhcp(t_now);
+    }
+}
+
+static void broker_failed(uint32_t t_now)
+{
+    // With a cached lease, the address may have been given to someone else
+    // since; ask DHCP before blaming the broker
+    if (m_fast)
+    {
+        Serial.println("Broker unreachable on the cached lease - asking DHCP");
+        join_with_dhcp(t_now);
+        return;
+    }
+
+    retry_later(t_now);
+}
+
+static void poll_broker(uint32_t t_now)
+{
+    if ((int32_t)(t_now - m_t_retry) < 0)
+        return;
+
+    // Looked up once and kept, as a lookup blocks for as long as DNS takes.
+    // Repeated failures look it up again, in case the broker has moved
+    if (!m_resolved)
+    {
+        if (!WiFi.hostByName(m_broker, m_broker_ip, CONNECTION_DNS_TIMEOUT))
+        {
+            Serial.printf("Could not resolve %s\r\n", m_broker);
+            broker_failed(t_now);
+            return;
+        }
+        m_client.setServer(m_broker_ip, CONNECTION_BROKER_PORT);
+        m_resolved = true;
+        m_failures = 0;
+    }
+
+    // An empty retained will wipes our last state, so we drop off the list
+    bool connected = (m_will_topic != nullptr)
+                         ? m_client.connect(m_client_id, m_broker_username, m_broker_password,
+                                            m_will_topic, 0, true, "")
+                         : m_client.connect(m_client_id, m_broker_username, m_broker_password);
+    if (connected)
+    {
+        m_backoff = CONNECTION_BACKOFF_MIN;
+        m_failures = 0;
+        if (m_boot.t_subscribed == 0)
+            m_boot.t_subscribed = t_now;
+        set_state(CONNECTION_SUBSCRIBED, t_now);
+        digitalWrite(LED_BUILTIN, LOW);
+
+        if (m_on_online != nullptr)
+            m_on_online();
+        return;
+    }
+
+    Serial.printf("Connection Failed! Code: %d\r\n", m_client.state());
+    if (++m_failures >= CONNECTION_RESOLVE_AFTER)
+        m_resolved = false;
+    broker_failed(t_now);
+}
+
+/*------------------------------- Public Functions ---------------------------*/
+
+void connection_initialise(connection_message_cb_t on_message, connection_online_cb_t on_online)
+{
+    m_on_online = on_online;
+
+    uint8_t mac[WL_MAC_ADDR_LENGTH];
+    WiFi.macAddress(mac);
+    sprintf(m_client_id, "esp8266-client-%02X:%02X:%02X:%02X:%02X:%02X",
+            mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+
+    Serial.printf("WiFi Credentials: %s, %s\r\n", server_get_ssid(), server_get_psk());
+
+    // Credentials and the AP cache live in our config; don't let the SDK
+    // write its own copy to flash on every begin()
+    WiFi.persistent(false);
+    WiFi.mode(WIFI_STA);
+    begin_wifi();
+    configTime(0, 0, CONNECTION_NTP_SERVER);
+
+    // Keep blocking socket calls short so frames keep flowing; the server
+    // is set once the broker has been looked up
+    m_espClient.setTimeout(CONNECTION_CONNECT_TIMEOUT);
+    m_client.setCallback(on_message);
+    m_client.setBufferSize(CONNECTION_BUFFER_SIZE);
+    m_client.setSocketTimeout(CONNECTION_SOCKET_TIMEOUT);
+
+    set_state(CONNECTION_WIFI, millis());
+}
+
+void connection_set_will(const char *topic)
+{
+    m_will_topic = topic;
+}
+
+void connection_loop(uint32_t t_now)
+{
+    switch (m_state)
+    {
+    case CONNECTION_WIFI:
+        poll_wifi(t_now);
+        break;
+
+    case CONNECTION_BROKER:
+        if (WiFi.status() != WL_CONNECTED)
+            set_state(CONNECTION_WIFI, t_now);
+        else
+            poll_broker(t_now);
+        break;
+
+    case CONNECTION_SUBSCRIBED:
+        if (WiFi.status() != WL_CONNECTED || !m_client.connected())
+        {
+            Serial.println("Connection lost, reconnecting");
+            m_reconnects++;
+            m_t_retry = t_now;
+            set_state((WiFi.status() == WL_CONNECTED) ? CONNECTION_BROKER : CONNECTION_WIFI, t_now);
+            break;
+        }
+        poll_lease(t_now);
+        {
+            uint32_t t_start = micros();
+            m_client.loop();
+            metrics_record(METRIC_MQTT_LOOP, micros() - t_start);
+        }
+        break;
+
+    case CONNECTION_PORTAL:
+        server_loop();
+        break;
+    }
+}
+
+connection_state_t connection_get_state(void)
+{
+    return m_state;
+}
+
+uint32_t connection_get_reconnects(void)
+{
+    return m_reconnects;
+}
+
+const connection_boot_t *connection_get_boot(void)
+{
+    return &m_boot;
+}
+
+bool connection_subscribe(const char *topic)
+{
+    return m_client.subscribe(topic);
+}
+
+bool connection_unsubscribe(const char *topic)
+{
+    return m_client.unsubscribe(topic);
+}
+
+bool connection_publish(const char *topic, const char *payload, bool retained)
+{
+    if (m_state != CONNECTION_SUBSCRIBED)
+        return false;
+
+    return m_client.publish(topic, payload, retained);
+}
+
+bool connection_publish(const char *topic, const uint8_t *payload, unsigned int length, bool retained)
+{
+    if (m_state != CONNECTION_SUBSCRIBED)
+        return false;
+
+    return m_client.publish(topic, payload, length, retained);
+}
+
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,65 @@
+/**
+ * @file connection.h
+ * @author James Bennion-Pedley
+ * @brief Non-blocking WiFi and MQTT connection manager
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef __FIRMWARE_SRC_CONNECTION_H__
+#define __FIRMWARE_SRC_CONNECTION_H__
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <stdint.h>
+
+/*---------------------------- Macros & Constants ----------------------------*/
+
+// Longest topic we publish on, and largest payload: the retained state
+// document, whose worst case (every counter at its maximum, four 16-character
+// groups and a 16-character program) measures 963 bytes
+#define CONNECTION_TOPIC_SIZE 64
+#define CONNECTION_PAYLOAD_SIZE 1100
+
+/*--------------------------------- Datatypes --------------------------------*/
+
+typedef enum
+{
+    CONNECTION_WIFI,       // Joining the access point
+    CONNECTION_BROKER,     // Waiting to (re)connect to the MQTT broker
+    CONNECTION_SUBSCRIBED, // Online and subscribed
+    CONNECTION_PORTAL,     // Never joined WiFi, serving the onboarding portal
+} connection_state_t;
+
+typedef struct
+{
+    uint32_t t_wifi;       // Boot to first WiFi connection, ms (0 = not yet)
+    uint32_t t_subscribed; // Boot to first MQTT subscription, ms (0 = not yet)
+    bool fast;             // Joined using the cached access point and lease
+} connection_boot_t;
+
+typedef void (*connection_message_cb_t)(char *topic, uint8_t *payload, unsigned int length);
+typedef void (*connection_online_cb_t)(void);
+
+/*--------------------------------- Functions --------------------------------*/
+
+void connection_initialise(connection_message_cb_t on_message, connection_online_cb_t on_online);
+void connection_loop(uint32_t t_now);
+
+// Retained topic the broker clears if we drop off without saying goodbye
+void connection_set_will(const char *topic);
+
+connection_state_t connection_get_state(void);
+uint32_t connection_get_reconnects(void);
+const connection_boot_t *connection_get_boot(void);
+
+bool connection_subscribe(const char *topic);
+bool connection_unsubscribe(const char *topic);
+bool connection_publish(const char *topic, const char *payload, bool retained = false);
+bool connection_publish(const char *topic, const uint8_t *payload, unsigned int length, bool retained = false);
+
+/*----------------------------------------------------------------------------*/
+
+#endif /* __FIRMWARE_SRC_CONNECTION_H__ */
@@ -0,0 +1,158 @@
+/**
+ * @file fire.cpp
+ * @author James Bennion-Pedley
+ * @brief Fire2012 flames of any length, for strips and grid columns
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <FastLED.h>
+
+#include "fire.h"
+
+/*---------------------------- Macros & Constants ----------------------------*/
+
+// As the original Fire: cells cool by one a tick, and sparks are 190-254 hot
+#define FIRE_SPARKING 60 // Chance of a spark, out of 256
+#define FIRE_SPARK_HEAT 190
+#define FIRE_SPARK_RANGE 65
+
+// Strips get a spark chance every FIRE_SPARK_SPAN pixels; columns only spark
+// in their bottom few cells
+#define FIRE_SPARK_SPAN 32
+#define FIRE_SPARK_DEPTH 3
+
+/*----------------------------------- State ----------------------------------*/
+
+static constexpr fire_palette_t make_fire_palette(void)
+{
+    fire_palette_t t = {};
+    for (uint16_t heat = 0; heat < 256; heat++)
+    {
+        // Half the heat, as the original dimmed it, then scale8_video(t, 191)
+        // and a ramp through each third
+        uint8_t temperature = heat / 2;
+        uint8_t t192 = ((temperature * 191) >> 8) + (temperature ? 1 : 0);
+        uint8_t ramp = (t192 & 0x3F) << 2;
+
+        uint8_t *c = t.rgb[heat];
+        c[0] = (t192 & 0xC0) ? 255 : ramp;
+        c[1] = (t192 & 0x80) ? 255 : (t192 & 0x40) ? ramp : 0;
+        c[2] = (t192 & 0x80) ? ramp : 0;
+    }
+    return t;
+}
+
+constexpr fire_palette_t fire_palette = make_fire_palette();
+
+/*------------------------------ Private Functions ---------------------------*/
+
+static inline uint8_t next_random(uint32_t &r)
+{
+    r ^= r << 13;
+    r ^= r >> 17;
+    r ^= r << 5;
+    return r;
+}
+
+// By one a tick, so any heat is gone within 255 ticks of its spark
+static inline uint8_t cool(uint8_t heat)
+{
+    return qsub8(heat, 1);
+}
+
+/*------------------------------- Public Functions ---------------------------*/
+
+void fire_strip(fire_t *f, uint8_t *heat, uint16_t length)
+{
+    f->heat = heat;
+    f->stride = 1;
+    f->length = length;
+    f->span = FIRE_SPARK_SPAN;
+    f->sparks = (length + FIRE_SPARK_SPAN - 1) / FIRE_SPARK_SPAN;
+}
+
+void fire_column(fire_t *f, uint8_t *heat, uint16_t length, int16_t stride)
+{
+    f->heat = heat;
+    f->stride = stride;
+    f->length = length;
+    f->span = (length < FIRE_SPARK_DEPTH) ? length : FIRE_SPARK_DEPTH;
+    f->sparks = (length > 0) ? 1 : 0;
+}
+
+void fire_tick(fire_t *f, uint32_t seed)
+{
+    uint16_t n = f->length;
+    int16_t s = f->stride;
+    uint32_t r = seed | 1; // xorshift never leaves zero
+
+    if (n < 3)
+    {
+        for (uint16_t k = n; k-- > 0;)
+            f->heat[k * s] = cool(f->heat[k * s]);
+    }
+    else
+    {
+        // Cooling and the original's drift (its Step 2, left commented out
+        // there) in one pass, from the top down. Each cell takes a third of
+        // the one below and two thirds of the one below that, as they were
+        // once cooled; cooled values are carried up to the two cells that use
+        // them, so each cell is read once. 85/256 is a third that needs no
+        // divide, and rounds heat down as it rises
+        uint8_t *p = f->heat + (int32_t)(n - 1) * s;
+        uint8_t a = cool(p[-s]);
+        uint8_t b = cool(p[-2 * s]);
+
+        for (uint16_t k = n - 1; k > 2; k--, p -= s)
+        {
+            *p = ((a + 2 * b) * 85) >> 8;
+            a = b;
+            b = cool(p[-3 * s]);
+        }
+
+        p[0] = ((a + 2 * b) * 85) >> 8;
+        p[-s] = a;
+        p[-2 * s] = b;
+    }
+
+    // Each span gets its own chance, so long strips spark as often per pixel
+    uint16_t base = 0;
+    for (uint16_t i = 0; i < f->sparks; i++, base += f->span)
+    {
+        next_random(r);
+        if ((uint8_t)r >= FIRE_SPARKING)
+            continue;
+
+        uint16_t room = (n - base < f->span) ? n - base : f->span;
+        uint16_t k = base + ((((r >> 8) & 0xFFFF) * room) >> 16);
+        uint8_t *cell = &f->heat[(int32_t)k * s];
+        *cell = qadd8(*cell, FIRE_SPARK_HEAT + (((r >> 24) * FIRE_SPARK_RANGE) >> 8));
+    }
+}
+
+void fire_draw(const uint8_t *heat, uint16_t cells, CRGB *leds, const uint16_t *xy)
+{
+    if (xy == nullptr)
+    {
+        for (uint16_t i = 0; i < cells; i++)
+        {
+            const uint8_t *c = fire_palette.rgb[heat[i]];
+            leds[i].setRGB(c[0], c[1], c[2]);
+        }
+    }
+    else
+    {
+        for (uint16_t i = 0; i < cells; i++)
+        {
+            const uint8_t *c = fire_palette.rgb[heat[i]];
+            leds[xy[i]].setRGB(c[0], c[1], c[2]);
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------*/
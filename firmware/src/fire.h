@@ -0,0 +1,57 @@
+/**
+ * @file fire.h
+ * @author James Bennion-Pedley
+ * @brief Fire2012 flames of any length, for strips and grid columns
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef __FIRMWARE_SRC_FIRE_H__
+#define __FIRMWARE_SRC_FIRE_H__
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <stdint.h>
+
+/*--------------------------------- Datatypes --------------------------------*/
+
+// One flame, rising from its bottom cell. The heat belongs to the caller,
+// so flames can be slices of one buffer: a strip each, or a grid's columns
+typedef struct
+{
+    uint8_t *heat;    // Bottom cell
+    int16_t stride;   // From each cell to the one above it
+    uint16_t length;  // Cells
+    uint16_t span;    // Each span of cells from the bottom has its own chance
+    uint16_t sparks;  // of a spark a tick, for this many spans
+} fire_t;
+
+// What the original Fire showed for each heat, HeatColor(heat / 2), built at
+// compile time
+typedef struct
+{
+    uint8_t rgb[256][3];
+} fire_palette_t;
+
+extern const fire_palette_t fire_palette;
+
+/*--------------------------------- Functions --------------------------------*/
+
+// Sparks anywhere along the strip, more of them the longer it is
+void fire_strip(fire_t *f, uint8_t *heat, uint16_t length);
+
+// Sparks near the bottom only, for a flame up a grid
+void fire_column(fire_t *f, uint8_t *heat, uint16_t length, int16_t stride);
+
+// One tick of cooling, rising heat and sparks; seed picks the tick's sparks
+void fire_tick(fire_t *f, uint32_t seed);
+
+// Colours cell i into leds[xy[i]], or leds[i] if xy is nullptr
+struct CRGB;
+void fire_draw(const uint8_t *heat, uint16_t cells, CRGB *leds, const uint16_t *xy);
+
+/*----------------------------------------------------------------------------*/
+
+#endif /* __FIRMWARE_SRC_FIRE_H__ */
@@ -0,0 +1,115 @@
+/**
+ * @file kernels.cpp
+ * @author James Bennion-Pedley
+ * @brief Whole-buffer byte arithmetic, four channels per word
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include "kernels.h"
+
+/*---------------------------- Macros & Constants ----------------------------*/
+
+#define KERNELS_HIGH 0x80808080UL // Top bit of each byte
+#define KERNELS_EVEN 0x00FF00FFUL // Bytes 0 and 2, each in a 16-bit lane
+
+/*------------------------------ Private Functions ---------------------------*/
+
+static inline bool aligned(const void *p)
+{
+    return ((uintptr_t)p & 3) == 0;
+}
+
+// Exact FastLED arithmetic (FASTLED_SCALE8_FIXED, FASTLED_BLEND_FIXED)
+static inline uint8_t sub_byte(uint8_t i, uint8_t j)
+{
+    return (i > j) ? i - j : 0;
+}
+
+static inline uint8_t scale_byte(uint8_t i, uint8_t scale)
+{
+    return (i * (1 + scale)) >> 8;
+}
+
+static inline uint8_t blend_byte(uint8_t a, uint8_t b, uint8_t amount)
+{
+    // blend8(): (a << 8 | b) + b * amount - a * amount, regrouped
+    return (a * (256 - amount) + b * (1 + amount)) >> 8;
+}
+
+/*------------------------------- Public Functions ---------------------------*/
+
+void kernels_sub(uint8_t *buf, size_t n, uint8_t value)
+{
+    size_t i = 0;
+
+    // Setting each byte's top bit first means subtracting up to 0x80 can't
+    // borrow from the next byte. Bytes that had it clear then get it
+    // flipped back, and they underflowed if the result's top bit is clear
+    if (value <= 0x80 && aligned(buf))
+    {
+        uint32_t sub = value * 0x01010101UL;
+        uint32_t *words = (uint32_t *)buf;
+        for (; i + 4 <= n; i += 4, words++)
+        {
+            uint32_t x = *words;
+            uint32_t s = (x | KERNELS_HIGH) - sub;
+            uint32_t under = ~x & ~s & KERNELS_HIGH;
+            *words = (s ^ (~x & KERNELS_HIGH)) & ~((under >> 7) * 0xFF);
+        }
+    }
+
+    for (; i < n; i++)
+        buf[i] = sub_byte(buf[i], value);
+}
+
+void kernels_scale(uint8_t *buf, size_t n, uint8_t scale)
+{
+    size_t i = 0;
+
+    // Alternate bytes in 16-bit lanes: 255 * 256 can't spill into the next
+    if (aligned(buf))
+    {
+        uint32_t mul = 1 + scale;
+        uint32_t *words = (uint32_t *)buf;
+        for (; i + 4 <= n; i += 4, words++)
+        {
+            uint32_t x = *words;
+            uint32_t even = (((x & KERNELS_EVEN) * mul) >> 8) & KERNELS_EVEN;
+            uint32_t odd = (((x >> 8) & KERNELS_EVEN) * mul) & ~KERNELS_EVEN;
+            *words = even | odd;
+        }
+    }
+
+    for (; i < n; i++)
+        buf[i] = scale_byte(buf[i], scale);
+}
+
+void kernels_blend(uint8_t *dest, const uint8_t *a, const uint8_t *b, size_t n, uint8_t amount)
+{
+    size_t i = 0;
+
+    // Same lanes as scaling: the weights sum to 257, and 255 * 257 fits
+    if (aligned(dest) && aligned(a) && aligned(b))
+    {
+        uint32_t wa = 256 - amount, wb = 1 + amount;
+        const uint32_t *words_a = (const uint32_t *)a, *words_b = (const uint32_t *)b;
+        uint32_t *words = (uint32_t *)dest;
+        for (; i + 4 <= n; i += 4, words++, words_a++, words_b++)
+        {
+            uint32_t x = *words_a, y = *words_b;
+            uint32_t even = (((x & KERNELS_EVEN) * wa + (y & KERNELS_EVEN) * wb) >> 8) & KERNELS_EVEN;
+            uint32_t odd = (((x >> 8) & KERNELS_EVEN) * wa + ((y >> 8) & KERNELS_EVEN) * wb) & ~KERNELS_EVEN;
+            *words = even | odd;
+        }
+    }
+
+    for (; i < n; i++)
+        dest[i] = blend_byte(a[i], b[i], amount);
+}
+
+/*----------------------------------------------------------------------------*/
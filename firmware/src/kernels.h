@@ -0,0 +1,37 @@
+/**
+ * @file kernels.h
+ * @author James Bennion-Pedley
+ * @brief Whole-buffer byte arithmetic, four channels per word
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef __FIRMWARE_SRC_KERNELS_H__
+#define __FIRMWARE_SRC_KERNELS_H__
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*--------------------------------- Functions --------------------------------*/
+
+// Each matches the FastLED function named, applied to every byte, exactly.
+// Buffers that are all 4-byte aligned go a word at a time; others fall back
+// to a byte loop
+
+// buf[i] = qsub8(buf[i], value)
+void kernels_sub(uint8_t *buf, size_t n, uint8_t value);
+
+// buf[i] = scale8(buf[i], scale)
+void kernels_scale(uint8_t *buf, size_t n, uint8_t scale);
+
+// dest[i] = blend8(a[i], b[i], amount), as nblend() does per channel; dest
+// may be a
+void kernels_blend(uint8_t *dest, const uint8_t *a, const uint8_t *b, size_t n, uint8_t amount);
+
+/*----------------------------------------------------------------------------*/
+
+#endif /* __FIRMWARE_SRC_KERNELS_H__ */
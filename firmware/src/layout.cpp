@@ -0,0 +1,169 @@
+/**
+ * @file layout.cpp
+ * @author James Bennion-Pedley
+ * @brief How the pixels are arranged, as a grid for 2D patterns
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include "layout.h"
+
+/*----------------------------------- State ----------------------------------*/
+
+static layout_config_t m_config;
+static uint16_t m_num_leds = 0;
+
+// Built whenever the layout or strips change, so a frame only ever looks up
+static uint16_t m_xy[LAYOUT_MAX_CELLS];
+static layout_grid_t m_grid = {0, 0, 0, m_xy};
+static bool m_active = false;
+
+/*------------------------------ Private Functions ---------------------------*/
+
+static uint8_t ring_count(const layout_config_t *cfg)
+{
+    uint8_t n = 0;
+    while (n < LAYOUT_MAX_RINGS && cfg->rings[n] != 0)
+        n++;
+    return n;
+}
+
+static uint8_t widest_ring(const layout_config_t *cfg)
+{
+    uint8_t widest = 0;
+    for (uint8_t i = 0; i < LAYOUT_MAX_RINGS; i++)
+        widest = (cfg->rings[i] > widest) ? cfg->rings[i] : widest;
+    return widest;
+}
+
+static void build_matrix(void)
+{
+    uint8_t w = m_config.width, h = m_config.height;
+    bool vertical = m_config.flags & LAYOUT_VERTICAL;
+
+    for (uint8_t y = 0; y < h; y++)
+    {
+        for (uint8_t x = 0; x < w; x++)
+        {
+            uint8_t wx = (m_config.flags & LAYOUT_FLIP_X) ? w - 1 - x : x;
+            uint8_t wy = (m_config.flags & LAYOUT_FLIP_Y) ? h - 1 - y : y;
+
+            // Position along the data line: which run, and how far along it
+            uint8_t run = vertical ? wx : wy;
+            uint8_t along = vertical ? wy : wx;
+            uint8_t length = vertical ? h : w;
+            if ((m_config.flags & LAYOUT_SERPENTINE) && (run & 1))
+                along = length - 1 - along;
+
+            m_xy[y * w + x] = run * length + along;
+        }
+    }
+
+    m_grid.width = w;
+    m_grid.height = h;
+    m_grid.pixels = w * h;
+}
+
+static void build_rings(void)
+{
+    uint8_t w = widest_ring(&m_config), h = ring_count(&m_config);
+    uint16_t offset = 0;
+
+    for (uint8_t y = 0; y < h; y++)
+    {
+        uint8_t count = m_config.rings[y];
+        for (uint8_t x = 0; x < w; x++)
+            m_xy[y * w + x] = offset + (x * count) / w;
+        offset += count;
+    }
+
+    m_grid.width = w;
+    m_grid.height = h;
+    m_grid.pixels = offset;
+}
+
+static uint16_t layout_pixels(const layout_config_t *cfg)
+{
+    if (cfg->type == LAYOUT_MATRIX)
+        return cfg->width * cfg->height;
+
+    uint16_t total = 0;
+    for (uint8_t i = 0; i < LAYOUT_MAX_RINGS; i++)
+        total += cfg->rings[i];
+    return total;
+}
+
+static bool build(void)
+{
+    if (m_config.type == LAYOUT_STRIP || layout_pixels(&m_config) > m_num_leds)
+        return false;
+
+    if (m_config.type == LAYOUT_MATRIX)
+        build_matrix();
+    else
+        build_rings();
+
+    return true;
+}
+
+/*------------------------------- Public Functions ---------------------------*/
+
+bool layout_valid(const layout_config_t *cfg)
+{
+    switch (cfg->type)
+    {
+    case LAYOUT_STRIP:
+        return true;
+
+    case LAYOUT_MATRIX:
+        return cfg->width > 0 && cfg->height > 0 && !(cfg->flags & ~LAYOUT_FLAGS) &&
+               cfg->width * cfg->height <= LAYOUT_MAX_CELLS;
+
+    case LAYOUT_RINGS:
+    {
+        // Nothing after the end of the list
+        uint8_t n = ring_count(cfg);
+        for (uint8_t i = n; i < LAYOUT_MAX_RINGS; i++)
+        {
+            if (cfg->rings[i] != 0)
+                return false;
+        }
+        return n > 0 && widest_ring(cfg) * n <= LAYOUT_MAX_CELLS;
+    }
+
+    default:
+        return false;
+    }
+}
+
+bool layout_configure(const layout_config_t *cfg)
+{
+    if (!layout_valid(cfg))
+        return false;
+
+    m_config = *cfg;
+    m_active = build();
+    return true;
+}
+
+const layout_config_t *layout_get_config(void)
+{
+    return &m_config;
+}
+
+void layout_resize(uint16_t num_leds)
+{
+    m_num_leds = num_leds;
+    m_active = build();
+}
+
+const layout_grid_t *layout_get_grid(void)
+{
+    return m_active ? &m_grid : nullptr;
+}
+
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,76 @@
+/**
+ * @file layout.h
+ * @author James Bennion-Pedley
+ * @brief How the pixels are arranged, as a grid for 2D patterns
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef __FIRMWARE_SRC_LAYOUT_H__
+#define __FIRMWARE_SRC_LAYOUT_H__
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <stdint.h>
+
+/*---------------------------- Macros & Constants ----------------------------*/
+
+#define LAYOUT_MAX_RINGS 8
+#define LAYOUT_MAX_CELLS 1024 // 32x32, or rings up to 128 pixels round
+
+// Matrix wiring, from the first pixel on the data line
+#define LAYOUT_SERPENTINE (1 << 0) // Every other row runs back the other way
+#define LAYOUT_VERTICAL (1 << 1)   // Wired in columns rather than rows
+#define LAYOUT_FLIP_X (1 << 2)     // First pixel on the right
+#define LAYOUT_FLIP_Y (1 << 3)     // First pixel at the bottom
+#define LAYOUT_FLAGS 0x0F
+
+/*--------------------------------- Datatypes --------------------------------*/
+
+typedef enum
+{
+    LAYOUT_STRIP,  // One line, end to end; patterns stay 1D
+    LAYOUT_MATRIX, // width x height
+    LAYOUT_RINGS,  // Concentric rings, outermost first
+} layout_type_t;
+
+// Zeroed is a plain strip, so configs stored before layouts existed load as one
+typedef struct
+{
+    uint8_t type;  // layout_type_t
+    uint8_t flags; // LAYOUT_*, matrices only
+    uint8_t width;
+    uint8_t height;
+    uint8_t rings[LAYOUT_MAX_RINGS]; // Pixels in each ring; 0 ends the list
+} layout_config_t;
+
+// Cells run row by row from the top left. On rings a row is a ring, and
+// columns go round it at equal angles (x * 256 / width), so smaller rings
+// have several cells on each pixel
+typedef struct
+{
+    uint8_t width;
+    uint8_t height;
+    uint16_t pixels;    // Pixels covered, from the start of the strips
+    const uint16_t *xy; // Pixel under each cell
+} layout_grid_t;
+
+/*--------------------------------- Functions --------------------------------*/
+
+bool layout_valid(const layout_config_t *cfg);
+
+// Rebuilds the cell table; false leaves the last layout in place
+bool layout_configure(const layout_config_t *cfg);
+const layout_config_t *layout_get_config(void);
+
+// Called when the strips change, as the layout may no longer fit them
+void layout_resize(uint16_t num_leds);
+
+// nullptr for a strip, or a layout with more pixels than the strips have
+const layout_grid_t *layout_get_grid(void);
+
+/*----------------------------------------------------------------------------*/
+
+#endif /* __FIRMWARE_SRC_LAYOUT_H__ */
@@ -12,212 +12,595 @@
 
 #include <FastLED.h>
 
+#include "audio.h"
+#include "fire.h"
+#include "kernels.h"
+#include "layout.h"
+#include "leds.h"
+#include "vm.h"
+#include "waves.h"
+
 /*---------------------------- Macros & Constants ----------------------------*/
 
 #define LED_PIN 0
 #define COLOR_ORDER GRB
 #define CHIPSET WS2812B
-#define NUM_LEDS 15
 
-// Pattern Definitions
-#define SPARKING 60
+// Size of the pixel arena shared by all strips, fixed at build time
+#ifndef NUM_LEDS
+#define NUM_LEDS 1024
+#endif
+
+// Strip used when nothing has been configured
+#define DEFAULT_LENGTH 15
+
+// GPIOs FastLED can drive on the ESP8266 (6-11 are the flash bus)
+#define LED_PINS(X) X(0) X(2) X(4) X(5) X(12) X(13) X(14) X(15)
+
+// Unchanged frames are still re-sent this often, to recover from glitches
+#define REFRESH_MS 1000
+
+// Fire and Sparkle step on this grid of shared time, so every light agrees
+#define RANDOM_TICK_MS 20
+#define FIRE_MEMORY 255  // Ticks for a spark to cool off completely
+#define SPARKLE_MEMORY 64 // Ticks for a sparkle to fade out (255 / 4)
+
+// Calming on a grid: each row starts a little further along every wave, so
+// they roll across it diagonally
+#define CALMING_ROW_CI 1536
+#define CALMING_ROW_ANGLE 2048
+#define CALMING_ROW_WAVE 24
+
+// Rainbow blends its new colours in this many pixels at a time
+#define RAINBOW_CHUNK 32
+
+// Music eases each frame in over the last, so sparkles trail off; beat
+// flashes fade over about 250 ms, and at most 32/256 of the pixels sparkle
+#define MUSIC_BLEND 96
+#define MUSIC_HUE_SHIFT 3 // Hue moves 1/8 of the way to the centroid a frame
+#define MUSIC_SPARKLE_MAX 32
 
 /*----------------------------------- State ----------------------------------*/
 
-static CRGB m_leds[NUM_LEDS];
+// Strips are consecutive slices of one arena; patterns see them end-to-end.
+// Stream mode fills the back arena and swaps it in at a frame boundary.
+// During a transition the back arena holds the outgoing pattern and the
+// layer arena the incoming one, and the front is their blend
+static CRGB m_arena_a[NUM_LEDS] __attribute__((aligned(4)));
+static CRGB m_arena_b[NUM_LEDS] __attribute__((aligned(4)));
+static CRGB m_arena_c[NUM_LEDS] __attribute__((aligned(4)));
+static CRGB *m_leds = m_arena_a;
+static CRGB *m_back = m_arena_b;
+static CRGB *m_layer = m_arena_c;
+static CRGB *m_draw = m_arena_a; // Where patterns render to
+static bool m_back_ready = false;
+static uint16_t m_num_leds = 0;
+static leds_config_t m_config;
+
+// Dirty-frame tracking
+static uint32_t m_shown_hash = 0;
+static uint32_t m_t_shown = 0;
+static leds_stats_t m_stats;
+
+// Time of the frame being rendered, for FastLED's beat functions
+static uint32_t m_t_frame = 0;
+
+// Ticks a random pattern has simulated up to, and what they depended on
+typedef struct
+{
+    uint32_t tick;
+    uint32_t seed;
+    uint32_t shape; // Strip length, or grid size
+    bool valid; // Cleared when the pattern starts on a fresh buffer
+} tick_history_t;
+
+// Random pattern state, reset by their start hooks
+// Temperature of each pixel, or each cell on a grid; every flame is a slice
+static uint8_t m_fire_heat[(NUM_LEDS > LAYOUT_MAX_CELLS) ? NUM_LEDS : LAYOUT_MAX_CELLS] __attribute__((aligned(4)));
+static tick_history_t m_fire_history;
+static tick_history_t m_fire_2d_history;
+static tick_history_t m_sparkle_history;
+
+// Music state, reset by its start hook
+typedef struct
+{
+    uint32_t t;     // Time of the last frame
+    uint32_t beats; // Beats seen so far
+    uint16_t hue16; // Palette position, following the spectral centroid
+    uint8_t pulse;  // Brightness lift from the last beat
+} music_state_t;
+
+static music_state_t m_music;
+
+// Calming (pacifica) wave speeds, as beatsin88() arguments
+static const waves_beatsin_t m_calming_speed[2] = {{3 << 8, 179, 269}, {4 << 8, 179, 269}};
+static const waves_beatsin_t m_calming_rate[4] = {{1011, 10, 13}, {777, 8, 11}, {501, 5, 7}, {257, 4, 6}};
+
+// Rainbow (pride) brightness and hue speeds
+static const waves_beatsin_t m_rainbow_pseudotime = {147, 23, 60};
+static const waves_beatsin_t m_rainbow_hue = {400, 5, 9};
 
-static CRGBPalette16 pacifica_palette_1 =
+// Calming (pacifica) palettes, expanded at compile time into 256-entry tables
+// holding exactly what ColorFromPalette(..., 255, LINEARBLEND) returns
+static constexpr uint32_t pacifica_colours_1[16] =
     {0x000507, 0x000409, 0x00030B, 0x00030D, 0x000210, 0x000212, 0x000114, 0x000117,
      0x000019, 0x00001C, 0x000026, 0x000031, 0x00003B, 0x000046, 0x14554B, 0x28AA50};
-static CRGBPalette16 pacifica_palette_2 =
+static constexpr uint32_t pacifica_colours_2[16] =
     {0x000507, 0x000409, 0x00030B, 0x00030D, 0x000210, 0x000212, 0x000114, 0x000117,
      0x000019, 0x00001C, 0x000026, 0x000031, 0x00003B, 0x000046, 0x0C5F52, 0x19BE5F};
-static CRGBPalette16 pacifica_palette_3 =
+static constexpr uint32_t pacifica_colours_3[16] =
     {0x000208, 0x00030E, 0x000514, 0x00061A, 0x000820, 0x000927, 0x000B2D, 0x000C33,
      0x000E39, 0x001040, 0x001450, 0x001860, 0x001C70, 0x002080, 0x1040BF, 0x2060FF};
 
+typedef struct
+{
+    uint8_t rgb[256][3];
+} palette_table_t;
+
+static constexpr palette_table_t make_palette_table(const uint32_t (&colours)[16])
+{
+    palette_table_t t = {};
+    for (uint16_t index = 0; index < 256; index++)
+    {
+        uint8_t hi4 = index >> 4;
+        uint8_t lo4 = index & 0x0F;
+        uint8_t f2 = lo4 << 4;
+        uint8_t f1 = 255 - f2;
+
+        for (uint8_t c = 0; c < 3; c++)
+        {
+            uint8_t shift = 16 - (8 * c);
+            uint8_t c1 = colours[hi4] >> shift;
+            uint8_t c2 = colours[(hi4 + 1) & 0x0F] >> shift;
+            t.rgb[index][c] = lo4 ? (uint8_t)(((c1 * (1 + f1)) >> 8) + ((c2 * (1 + f2)) >> 8)) : c1;
+        }
+    }
+    return t;
+}
+
+static constexpr palette_table_t pacifica_table_1 = make_palette_table(pacifica_colours_1);
+static constexpr palette_table_t pacifica_table_2 = make_palette_table(pacifica_colours_2);
+static constexpr palette_table_t pacifica_table_3 = make_palette_table(pacifica_colours_3);
+
+// Music palette: FastLED's PartyColors_p, purples and reds up to golds
+static constexpr uint32_t music_colours[16] =
+    {0x5500AB, 0x84007C, 0xB5004B, 0xE5001B, 0xE81700, 0xB84700, 0xAB7700, 0xABAB00,
+     0xAB5500, 0xDD2200, 0xF2000E, 0xC2003E, 0x8F0071, 0x5F00A1, 0x2F00D0, 0x0007F9};
+static constexpr palette_table_t music_table = make_palette_table(music_colours);
+
+// sin16() only depends on bits 4-15 of the angle and mirrors about each
+// quarter turn, so a 1024-entry quarter-wave table reproduces it exactly
+typedef struct
+{
+    uint16_t v[1024];
+} sin16_table_t;
+
+static constexpr sin16_table_t make_sin16_table(void)
+{
+    const uint16_t base[] = {0, 6393, 12539, 18204, 23170, 27245, 30273, 32137};
+    const uint8_t slope[] = {49, 48, 44, 38, 31, 23, 14, 4};
+
+    sin16_table_t t = {};
+    for (uint16_t q = 0; q < 1024; q++)
+        t.v[q] = base[q >> 7] + slope[q >> 7] * (q & 0x7F);
+    return t;
+}
+
+static constexpr sin16_table_t sin16_table = make_sin16_table();
+
 /*------------------------------ Private Functions ---------------------------*/
 
-static void pacifica_one_layer(CRGBPalette16 &p, uint16_t cistart, uint16_t wavescale, uint8_t bri, uint16_t ioff)
+static bool pin_supported(uint8_t pin)
 {
-    uint16_t ci = cistart;
-    uint16_t waveangle = ioff;
-    uint16_t wavescale_half = (wavescale / 2) + 20;
-    for (uint16_t i = 0; i < NUM_LEDS; i++)
+    switch (pin)
     {
-        waveangle += 250;
-        uint16_t s16 = sin16(waveangle) + 32768;
-        uint16_t cs = scale16(s16, wavescale_half) + wavescale_half;
-        ci += cs;
-        uint16_t sindex16 = sin16(ci) + 32768;
-        uint8_t sindex8 = scale16(sindex16, 240);
-        CRGB c = ColorFromPalette(p, sindex8, bri, LINEARBLEND);
-        m_leds[i] += c;
+#define LED_PIN_CASE(p) case p:
+        LED_PINS(LED_PIN_CASE)
+#undef LED_PIN_CASE
+        return true;
+    default:
+        return false;
     }
 }
 
-// Add extra 'white' to areas where the four layers of light have lined up brightly
-static void pacifica_add_whitecaps()
+static void add_strip(uint8_t pin, CRGB *data, uint16_t length)
 {
-    uint8_t basethreshold = beatsin8(9, 55, 65);
-    uint8_t wave = beat8(7);
+    // The data pin is a template parameter, so each supported pin is its own case
+    switch (pin)
+    {
+#define LED_PIN_CASE(p)                                                                        \
+    case p:                                                                                    \
+        FastLED.addLeds<CHIPSET, p, COLOR_ORDER>(data, length).setCorrection(TypicalLEDStrip); \
+        break;
+        LED_PINS(LED_PIN_CASE)
+#undef LED_PIN_CASE
+    }
+}
+
+static bool config_valid(const leds_config_t *cfg)
+{
+    if (cfg->count == 0 || cfg->count > LEDS_MAX_STRIPS)
+        return false;
 
-    for (uint16_t i = 0; i < NUM_LEDS; i++)
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < cfg->count; i++)
     {
-        uint8_t threshold = scale8(sin8(wave), 20) + basethreshold;
-        wave += 7;
-        uint8_t l = m_leds[i].getAverageLight();
-        if (l > threshold)
+        if (cfg->strips[i].length == 0 || !pin_supported(cfg->strips[i].pin))
+            return false;
+
+        for (uint8_t j = 0; j < i; j++)
         {
-            uint8_t overage = l - threshold;
-            uint8_t overage2 = qadd8(overage, overage);
-            m_leds[i] += CRGB(overage, overage2, qadd8(overage2, overage2));
+            if (cfg->strips[j].pin == cfg->strips[i].pin)
+                return false;
         }
+
+        total += cfg->strips[i].length;
     }
+
+    return total <= NUM_LEDS;
 }
 
-// Deepen the blues and greens
-void pacifica_deepen_colors()
+static void set_lengths(const leds_config_t *cfg)
 {
-    for (uint16_t i = 0; i < NUM_LEDS; i++)
+    uint16_t offset = 0;
+    for (uint8_t i = 0; i < cfg->count; i++)
     {
-        m_leds[i].blue = scale8(m_leds[i].blue, 145);
-        m_leds[i].green = scale8(m_leds[i].green, 200);
-        m_leds[i] |= CRGB(2, 5, 7);
+        FastLED[i].setLeds(&m_leds[offset], cfg->strips[i].length);
+        offset += cfg->strips[i].length;
     }
+
+    m_num_leds = offset;
 }
 
-/*------------------------------- Public Functions ---------------------------*/
+// FNV-1a over whole words of the frame, plus anything else that changes output
+static uint32_t frame_hash(void)
+{
+    const uint8_t *bytes = (const uint8_t *)m_leds;
+    size_t len = m_num_leds * sizeof(CRGB);
+    uint32_t hash = 2166136261UL ^ m_num_leds ^ ((uint32_t)FastLED.getBrightness() << 16);
+
+    size_t i = 0;
+    for (; i + 4 <= len; i += 4)
+    {
+        uint32_t word;
+        memcpy(&word, &bytes[i], sizeof(word));
+        hash = (hash ^ word) * 16777619UL;
+    }
+
+    for (; i < len; i++)
+        hash = (hash ^ bytes[i]) * 16777619UL;
 
-void leds_pattern_off(void)
+    return hash;
+}
+
+// Random numbers are a hash of seed and tick instead of a running generator,
+// so lights that started at different times still draw the same ones
+static inline uint32_t tick_random(uint32_t seed, uint32_t tick)
 {
-    FastLED.clear(true);
-    FastLED.show();
+    uint32_t x = seed ^ (tick * 0x9E3779B9UL);
+    x ^= x >> 16;
+    x *= 0x7FEB352DUL;
+    x ^= x >> 15;
+    x *= 0x846CA68BUL;
+    x ^= x >> 16;
+    return x;
 }
 
-void leds_pattern_solid(uint8_t *cols)
+// Returns how many ticks a random pattern has to simulate, from *next. Ticks
+// older than 'memory' no longer affect the output, so a light that is just
+// starting, fell behind, or had its seed or shape changed clears its state
+// and replays exactly that many, ending up where every other light is
+static uint32_t ticks_pending(tick_history_t &h, const leds_frame_t *frame, uint32_t memory, uint32_t shape,
+                              uint32_t *next)
 {
-    for (int i = 0; i < NUM_LEDS; i++)
+    uint32_t now = frame->t / RANDOM_TICK_MS;
+    uint32_t count = now - h.tick;
+
+    if (!h.valid || count > memory || h.seed != frame->seed || h.shape != shape)
+        count = memory;
+
+    *next = now - count + 1;
+    h.tick = now;
+    h.seed = frame->seed;
+    h.shape = shape;
+    h.valid = true;
+
+    return count;
+}
+
+static inline int16_t sin16_lut(uint16_t theta)
+{
+    uint16_t q = (theta >> 4) & 0x3FF;
+    if (theta & 0x4000)
+        q = 1023 - q;
+
+    int16_t y = sin16_table.v[q];
+    return (theta & 0x8000) ? -y : y;
+}
+
+typedef struct
+{
+    const palette_table_t *palette;
+    uint16_t ci;
+    uint16_t waveangle;
+    uint16_t wavescale_half;
+    uint16_t bri_mul; // ColorFromPalette's brightness step as a single multiply
+} pacifica_layer_t;
+
+static void pacifica_layer_init(pacifica_layer_t &l, const palette_table_t &p, uint16_t cistart,
+                                uint16_t wavescale, uint8_t bri, uint16_t ioff)
+{
+    l.palette = &p;
+    l.ci = cistart;
+    l.waveangle = ioff;
+    l.wavescale_half = (wavescale / 2) + 20;
+    l.bri_mul = (bri == 255) ? 256 : (bri == 0) ? 0 : bri + 2;
+}
+
+static inline const uint8_t *pacifica_layer_step(pacifica_layer_t &l)
+{
+    l.waveangle += 250;
+    uint16_t s16 = sin16_lut(l.waveangle) + 32768;
+    uint16_t cs = scale16(s16, l.wavescale_half) + l.wavescale_half;
+    l.ci += cs;
+    uint16_t sindex16 = sin16_lut(l.ci) + 32768;
+    uint8_t sindex8 = scale16(sindex16, 240);
+    return l.palette->rgb[sindex8];
+}
+
+// Background, layers, whitecaps and deepening fused into one pass. The
+// layers only ever add, so one saturation at the end matches chained qadd8s
+static inline CRGB pacifica_pixel(pacifica_layer_t (&layers)[4], uint8_t threshold)
+{
+    uint16_t r = 2, g = 6, b = 10; // Dim background blue-green
+    for (pacifica_layer_t &l : layers)
     {
-        CRGB colour;
-        colour.raw[0] = cols[0];
-        colour.raw[1] = cols[1];
-        colour.raw[2] = cols[2];
-        m_leds[i] = colour;
+        const uint8_t *c = pacifica_layer_step(l);
+        r += (c[0] * l.bri_mul) >> 8;
+        g += (c[1] * l.bri_mul) >> 8;
+        b += (c[2] * l.bri_mul) >> 8;
+    }
+    CRGB px((r > 255) ? 255 : r, (g > 255) ? 255 : g, (b > 255) ? 255 : b);
+
+    // Add extra 'white' where the four layers have lined up brightly
+    uint8_t light = px.getAverageLight();
+    if (light > threshold)
+    {
+        uint8_t overage = light - threshold;
+        uint8_t overage2 = qadd8(overage, overage);
+        px += CRGB(overage, overage2, qadd8(overage2, overage2));
     }
+
+    // Deepen the blues and greens
+    px.blue = scale8(px.blue, 145);
+    px.green = scale8(px.green, 200);
+    px |= CRGB(2, 5, 7);
+
+    return px;
 }
 
-void leds_pattern_fire(void)
+// Pixels past the end of a grid aren't drawn by 2D patterns
+static void clear_uncovered(const layout_grid_t *grid)
 {
-    // Array of temperature readings at each simulation cell
-    static uint8_t heat[NUM_LEDS];
+    if (grid->pixels < m_num_leds)
+        memset(&m_draw[grid->pixels], 0, (m_num_leds - grid->pixels) * sizeof(CRGB));
+}
 
-    // Step 1.  Cool down every cell a little
-    for (int i = 0; i < NUM_LEDS; i++)
+// Each row runs the strip version's waves, started further along
+static void calming_2d(const layout_grid_t *grid, const pacifica_layer_t (&start)[4], uint8_t basethreshold,
+                       uint8_t wave)
+{
+    const uint16_t *xy = grid->xy;
+    for (uint8_t y = 0; y < grid->height; y++)
     {
-        heat[i] = qsub8(heat[i], 1);
+        pacifica_layer_t layers[4];
+        for (uint8_t k = 0; k < 4; k++)
+        {
+            layers[k] = start[k];
+            layers[k].ci += y * CALMING_ROW_CI;
+            layers[k].waveangle += y * CALMING_ROW_ANGLE;
+        }
+
+        uint8_t row_wave = wave + y * CALMING_ROW_WAVE;
+        for (uint8_t x = 0; x < grid->width; x++, xy++)
+        {
+            uint8_t threshold = scale8(sin8(row_wave), 20) + basethreshold;
+            row_wave += 7;
+            m_draw[*xy] = pacifica_pixel(layers, threshold);
+        }
     }
 
-    // // Step 2.  Heat from each cell drifts 'up' and diffuses a little
-    // for (int k = NUM_LEDS - 1; k >= 2; k--)
-    // {
-    //     heat[k] = (heat[k - 1] + heat[k - 2] + heat[k - 2]) / 3;
-    // }
+    clear_uncovered(grid);
+}
+
+// Every flame draws its own numbers, so strips and columns don't burn in step
+static inline uint32_t flame_random(uint32_t seed, uint16_t flame, uint32_t tick)
+{
+    return tick_random(seed ^ (flame * 0x85EBCA6BUL), tick);
+}
 
-    // Step 3.  Randomly ignite new 'sparks' of heat near the bottom
-    if (random8() < SPARKING)
+// Strip lengths folded into one word, so resizing any of them starts afresh
+static uint32_t strips_shape(void)
+{
+    uint32_t shape = m_config.count;
+    for (uint8_t i = 0; i < m_config.count; i++)
+        shape = (shape * 16777619UL) ^ m_config.strips[i].length;
+    return shape;
+}
+
+// A flame up each column, rising from the bottom row (the innermost ring)
+static void fire_2d(const layout_grid_t *grid, const leds_frame_t *frame)
+{
+    uint8_t w = grid->width, h = grid->height;
+    uint16_t cells = w * h;
+    uint8_t *heat = m_fire_heat;
+
+    uint32_t tick;
+    uint32_t count = ticks_pending(m_fire_2d_history, frame, FIRE_MEMORY, cells | (w << 16), &tick);
+    if (count == FIRE_MEMORY)
+        memset(heat, 0, cells);
+
+    // Columns don't share heat, so each can run all its ticks in one go
+    for (uint8_t x = 0; x < w; x++)
     {
-        int y = random8(NUM_LEDS - 1);
-        heat[y] = qadd8(heat[y], random8(190, 255));
+        fire_t flame;
+        fire_column(&flame, &heat[(h - 1) * w + x], h, -w);
+        for (uint32_t i = 0; i < count; i++)
+            fire_tick(&flame, flame_random(frame->seed, x, tick + i));
     }
 
-    // Step 4.  Map from heat cells to LED colors
-    for (int j = 0; j < NUM_LEDS; j++)
+    fire_draw(heat, cells, m_draw, grid->xy);
+    clear_uncovered(grid);
+}
+
+/*------------------------------- Public Functions ---------------------------*/
+
+// With USE_GET_MILLISECOND_TIMER, FastLED's beat functions read this rather
+// than millis(), so they follow the frame being rendered
+uint32_t get_millisecond_timer(void)
+{
+    return m_t_frame;
+}
+
+void leds_pattern_off(const leds_frame_t *frame)
+{
+    memset(m_draw, 0, m_num_leds * sizeof(CRGB));
+}
+
+void leds_pattern_solid(const leds_frame_t *frame)
+{
+    for (int i = 0; i < m_num_leds; i++)
     {
-        CRGB color = HeatColor(heat[j] / 2);
-        int pixelnumber = j;
-        m_leds[pixelnumber] = color;
+        CRGB colour;
+        colour.raw[0] = frame->cols[0];
+        colour.raw[1] = frame->cols[1];
+        colour.raw[2] = frame->cols[2];
+        m_draw[i] = colour;
     }
 }
 
-void leds_pattern_sparkle(uint8_t *cols)
+void leds_pattern_fire_start(void)
 {
-    static uint32_t i = 0;
+    m_fire_history.valid = false;
+    m_fire_2d_history.valid = false;
+}
 
-    for (int j = 0; j < NUM_LEDS; j++)
+void leds_pattern_fire(const leds_frame_t *frame)
+{
+    // The two share a heat buffer, so switching between them starts afresh
+    const layout_grid_t *grid = layout_get_grid();
+    if (grid != nullptr)
     {
-        m_leds[j].subtractFromRGB(4);
+        m_fire_history.valid = false;
+        fire_2d(grid, frame);
+        return;
     }
+    m_fire_2d_history.valid = false;
 
-    if (i % 8 == 0)
-    {
-        size_t led = rand() % NUM_LEDS;
-        m_leds[led].setRGB(cols[0], cols[1], cols[2]);
+    uint32_t tick;
+    uint32_t count = ticks_pending(m_fire_history, frame, FIRE_MEMORY, strips_shape(), &tick);
+    if (count == FIRE_MEMORY)
+        memset(m_fire_heat, 0, m_num_leds);
 
-        // size_t led2 = rand() % NUM_LEDS;
-        // m_pixels.setPixelColor(led2, m_pixels.Color(250, 100, 255));
+    // A flame up each strip, from its first pixel
+    uint16_t offset = 0;
+    for (uint8_t s = 0; s < m_config.count; s++)
+    {
+        fire_t flame;
+        fire_strip(&flame, &m_fire_heat[offset], m_config.strips[s].length);
+        for (uint32_t i = 0; i < count; i++)
+            fire_tick(&flame, flame_random(frame->seed, s, tick + i));
+        offset += m_config.strips[s].length;
     }
 
-    i++;
+    fire_draw(m_fire_heat, m_num_leds, m_draw, nullptr);
+}
+
+void leds_pattern_sparkle_start(void)
+{
+    m_sparkle_history.valid = false;
 }
 
-void leds_pattern_calming(void)
+void leds_pattern_sparkle(const leds_frame_t *frame)
 {
-    // Increment the four "color index start" counters, one for each wave layer.
-    // Each is incremented at a different speed, and the speeds vary over time.
-    static uint16_t sCIStart1, sCIStart2, sCIStart3, sCIStart4;
-    static uint32_t sLastms = 0;
-    uint32_t ms = GET_MILLIS();
-    uint32_t deltams = ms - sLastms;
-    sLastms = ms;
-    uint16_t speedfactor1 = beatsin16(3, 179, 269);
-    uint16_t speedfactor2 = beatsin16(4, 179, 269);
-    uint32_t deltams1 = (deltams * speedfactor1) / 256;
-    uint32_t deltams2 = (deltams * speedfactor2) / 256;
-    uint32_t deltams21 = (deltams1 + deltams2) / 2;
-    sCIStart1 += (deltams1 * beatsin88(1011, 10, 13));
-    sCIStart2 -= (deltams21 * beatsin88(777, 8, 11));
-    sCIStart3 -= (deltams1 * beatsin88(501, 5, 7));
-    sCIStart4 -= (deltams2 * beatsin88(257, 4, 6));
+    // The pixels are the state here, so a fresh buffer replays from black
+    uint32_t tick;
+    uint32_t count = ticks_pending(m_sparkle_history, frame, SPARKLE_MEMORY, m_num_leds, &tick);
+    if (count == SPARKLE_MEMORY)
+        memset(m_draw, 0, m_num_leds * sizeof(CRGB));
 
-    // Clear out the LED array to a dim background blue-green
-    fill_solid(m_leds, NUM_LEDS, CRGB(2, 6, 10));
+    for (; count > 0; count--, tick++)
+    {
+        kernels_sub((uint8_t *)m_draw, m_num_leds * sizeof(CRGB), 4);
 
-    // Render each of four layers, with different scales and speeds, that vary over time
-    pacifica_one_layer(pacifica_palette_1, sCIStart1, beatsin16(3, 11 * 256, 14 * 256), beatsin8(10, 70, 130), 0 - beat16(301));
-    pacifica_one_layer(pacifica_palette_2, sCIStart2, beatsin16(4, 6 * 256, 9 * 256), beatsin8(17, 40, 80), beat16(401));
-    pacifica_one_layer(pacifica_palette_3, sCIStart3, 6 * 256, beatsin8(9, 10, 38), 0 - beat16(503));
-    pacifica_one_layer(pacifica_palette_3, sCIStart4, 5 * 256, beatsin8(8, 10, 28), beat16(601));
+        if (tick % 8 == 0)
+        {
+            size_t led = tick_random(frame->seed, tick) % m_num_leds;
+            m_draw[led].setRGB(frame->cols[0], frame->cols[1], frame->cols[2]);
+        }
+    }
+}
 
-    // Add brighter 'whitecaps' where the waves lines up more
-    pacifica_add_whitecaps();
+void leds_pattern_calming(const leds_frame_t *frame)
+{
+    m_t_frame = frame->t;
+
+    // The four "color index start" counters, one for each wave layer. Each
+    // moves at a different speed, and the speeds vary over time; they're the
+    // running totals of those speeds, worked out from the shared clock
+    const waves_beatsin_t *speed = m_calming_speed, *rate = m_calming_rate;
+    uint16_t sCIStart1 = waves_product_integral(frame->t, &speed[0], &rate[0], 256);
+    uint16_t sCIStart2 = 0 - waves_product_integral(frame->t, &speed[0], &rate[1], 512) -
+                         waves_product_integral(frame->t, &speed[1], &rate[1], 512);
+    uint16_t sCIStart3 = 0 - waves_product_integral(frame->t, &speed[0], &rate[2], 256);
+    uint16_t sCIStart4 = 0 - waves_product_integral(frame->t, &speed[1], &rate[3], 256);
+
+    // Four layers, with different scales and speeds, that vary over time
+    pacifica_layer_t layers[4];
+    pacifica_layer_init(layers[0], pacifica_table_1, sCIStart1, beatsin16(3, 11 * 256, 14 * 256), beatsin8(10, 70, 130), 0 - beat16(301));
+    pacifica_layer_init(layers[1], pacifica_table_2, sCIStart2, beatsin16(4, 6 * 256, 9 * 256), beatsin8(17, 40, 80), beat16(401));
+    pacifica_layer_init(layers[2], pacifica_table_3, sCIStart3, 6 * 256, beatsin8(9, 10, 38), 0 - beat16(503));
+    pacifica_layer_init(layers[3], pacifica_table_3, sCIStart4, 5 * 256, beatsin8(8, 10, 28), beat16(601));
 
-    // Deepen the blues and greens a bit
-    pacifica_deepen_colors();
+    uint8_t basethreshold = beatsin8(9, 55, 65);
+    uint8_t wave = beat8(7);
+
+    const layout_grid_t *grid = layout_get_grid();
+    if (grid != nullptr)
+    {
+        calming_2d(grid, layers, basethreshold, wave);
+        return;
+    }
+
+    for (uint16_t i = 0; i < m_num_leds; i++)
+    {
+        uint8_t threshold = scale8(sin8(wave), 20) + basethreshold;
+        wave += 7;
+        m_draw[i] = pacifica_pixel(layers, threshold);
+    }
 }
 
-void leds_pattern_rainbow(void)
+void leds_pattern_rainbow(const leds_frame_t *frame)
 {
-    static uint16_t sPseudotime = 0;
-    static uint16_t sLastMillis = 0;
-    static uint16_t sHue16 = 0;
+    m_t_frame = frame->t;
 
     uint8_t sat8 = beatsin88(87, 220, 250);
     uint8_t brightdepth = beatsin88(341, 96, 224);
     uint16_t brightnessthetainc16 = beatsin88(203, (25 * 256), (40 * 256));
-    uint8_t msmultiplier = beatsin88(147, 23, 60);
 
-    uint16_t hue16 = sHue16; // gHue * 256;
+    uint16_t hue16 = waves_integral(frame->t, &m_rainbow_hue, 1); // gHue * 256;
     uint16_t hueinc16 = beatsin88(113, 1, 3000);
 
-    uint16_t ms = millis();
-    uint16_t deltams = ms - sLastMillis;
-    sLastMillis = ms;
-    sPseudotime += deltams * msmultiplier;
-    sHue16 += deltams * beatsin88(400, 5, 9);
-    uint16_t brightnesstheta16 = sPseudotime;
+    // Pseudotime: the running total of a 23-60x speed multiplier
+    uint16_t brightnesstheta16 = waves_integral(frame->t, &m_rainbow_pseudotime, 1);
 
-    for (uint16_t i = 0; i < NUM_LEDS; i++)
+    // Pixels are drawn last to first, a chunk of new colours at a time, each
+    // blended in with one pass. Chunks start on a multiple of RAINBOW_CHUNK
+    // pixels so they stay word aligned
+    CRGB chunk[RAINBOW_CHUNK] __attribute__((aligned(4)));
+    uint16_t end = m_num_leds;
+    uint16_t start = ((m_num_leds - 1) / RAINBOW_CHUNK) * RAINBOW_CHUNK;
+    for (uint16_t pixelnumber = end; pixelnumber-- > 0;)
     {
         hue16 += hueinc16;
         uint8_t hue8 = hue16 / 256;
@@ -229,28 +612,233 @@ void leds_pattern_rainbow(void)
         uint8_t bri8 = (uint32_t)(((uint32_t)bri16) * brightdepth) / 65536;
         bri8 += (255 - brightdepth);
 
-        CRGB newcolor = CHSV(hue8, sat8, bri8);
+        chunk[pixelnumber - start] = CHSV(hue8, sat8, bri8);
 
-        uint16_t pixelnumber = i;
-        pixelnumber = (NUM_LEDS - 1) - pixelnumber;
+        if (pixelnumber == start)
+        {
+            uint8_t *dest = (uint8_t *)&m_draw[start];
+            kernels_blend(dest, dest, (const uint8_t *)chunk, (end - start) * sizeof(CRGB), 64);
+            end = start;
+            start -= (start > 0) ? RAINBOW_CHUNK : 0;
+        }
+    }
+}
+
+void leds_pattern_stream(const leds_frame_t *frame)
+{
+    // Frames are received straight into the back arena; showing one is just
+    // pointing the strips at it. Without a new frame the last one stays up
+    if (!m_back_ready)
+        return;
+
+    CRGB *front = m_back;
+    m_back = m_leds;
+    m_leds = front;
+    m_draw = front;
+    set_lengths(&m_config);
+
+    m_back_ready = false;
+}
+
+void leds_pattern_custom(const leds_frame_t *frame)
+{
+    // Programs use the same beat functions as the built-in patterns
+    m_t_frame = frame->t;
+    vm_render(frame, (uint8_t *)m_draw, m_num_leds);
+}
 
-        nblend(m_leds[pixelnumber], newcolor, 64);
+void leds_pattern_music_start(void)
+{
+    audio_reset();
+    memset(&m_music, 0, sizeof(m_music));
+}
+
+void leds_pattern_music(const leds_frame_t *frame)
+{
+    // Whatever was sampled since the last frame, a block at a time
+    audio_poll();
+    const audio_features_t *a = audio_get_features();
+
+    uint32_t dt = frame->t - m_music.t;
+    m_music.t = frame->t;
+    m_music.pulse = qsub8(m_music.pulse, (dt > 255) ? 255 : dt);
+    if (a->beats != m_music.beats)
+    {
+        m_music.beats = a->beats;
+        m_music.pulse = 255;
     }
+
+    // Bass-heavy sound sits at the purple and red end of the palette, and
+    // brighter sound moves it towards gold
+    int32_t hue_error = ((int32_t)a->centroid << 8) - m_music.hue16;
+    m_music.hue16 += hue_error / (1 << MUSIC_HUE_SHIFT);
+
+    // Loudness sets the brightness, beats lift it, and the mids stretch the
+    // palette along the strip
+    uint8_t bri = qadd8(scale8(a->level, 191), scale8(m_music.pulse, 64));
+    uint8_t spread = 1 + (a->bands[2] >> 5);
+    uint8_t index = m_music.hue16 >> 8;
+
+    CRGB chunk[RAINBOW_CHUNK] __attribute__((aligned(4)));
+    for (uint16_t start = 0; start < m_num_leds; start += RAINBOW_CHUNK)
+    {
+        uint16_t count = (m_num_leds - start < RAINBOW_CHUNK) ? m_num_leds - start : RAINBOW_CHUNK;
+        for (uint16_t j = 0; j < count; j++, index += spread)
+        {
+            const uint8_t *c = music_table.rgb[index];
+            chunk[j].setRGB(c[0], c[1], c[2]);
+        }
+
+        kernels_scale((uint8_t *)chunk, count * sizeof(CRGB), bri);
+        uint8_t *dest = (uint8_t *)&m_draw[start];
+        kernels_blend(dest, dest, (const uint8_t *)chunk, count * sizeof(CRGB), MUSIC_BLEND);
+    }
+
+    // Highs and beats scatter sparkles of the command colour. Sound differs
+    // from room to room anyway, so these aren't kept in step between lights
+    uint8_t density = scale8(qadd8(a->bands[AUDIO_BANDS - 1], m_music.pulse >> 1), MUSIC_SPARKLE_MAX);
+    uint16_t sparkles = ((uint32_t)m_num_leds * density) >> 8;
+    for (uint16_t i = 0; i < sparkles; i++)
+        m_draw[random16(m_num_leds)].setRGB(frame->cols[0], frame->cols[1], frame->cols[2]);
 }
 
 /*----------------------------------------------------------------------------*/
 
-void leds_initialise(void)
+void leds_default_config(leds_config_t *cfg)
 {
-    FastLED.addLeds<CHIPSET, LED_PIN, COLOR_ORDER>(m_leds, NUM_LEDS).setCorrection(TypicalLEDStrip);
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->count = 1;
+    cfg->strips[0].pin = LED_PIN;
+    cfg->strips[0].length = DEFAULT_LENGTH;
+}
+
+void leds_initialise(const leds_config_t *cfg)
+{
+    if (cfg == nullptr || !config_valid(cfg))
+        leds_default_config(&m_config);
+    else
+        m_config = *cfg;
+
+    for (uint8_t i = 0; i < m_config.count; i++)
+        add_strip(m_config.strips[i].pin, m_leds, m_config.strips[i].length);
+    set_lengths(&m_config);
+    layout_resize(m_num_leds);
+
     FastLED.setBrightness(255);
     FastLED.clear(true);
     FastLED.show();
 }
 
+leds_config_result_t leds_configure(const leds_config_t *cfg)
+{
+    if (!config_valid(cfg))
+        return LEDS_CONFIG_INVALID;
+
+    // FastLED controllers can't be removed, so new pins need a restart
+    if (cfg->count != m_config.count)
+        return LEDS_CONFIG_RESTART;
+
+    for (uint8_t i = 0; i < cfg->count; i++)
+    {
+        if (cfg->strips[i].pin != m_config.strips[i].pin)
+            return LEDS_CONFIG_RESTART;
+    }
+
+    // Blank the old lengths first so shortened strips don't leave pixels lit
+    FastLED.clear(true);
+
+    m_config = *cfg;
+    set_lengths(&m_config);
+    layout_resize(m_num_leds);
+
+    return LEDS_CONFIG_APPLIED;
+}
+
+const leds_config_t *leds_get_config(void)
+{
+    return &m_config;
+}
+
 void leds_render(void)
 {
+    // Skip identical frames: show() blocks interrupts for ~30us per LED
+    uint32_t hash = frame_hash();
+    uint32_t t_now = millis();
+    if (hash == m_shown_hash && (t_now - m_t_shown) < REFRESH_MS)
+    {
+        m_stats.skipped++;
+        return;
+    }
+
     FastLED.show(); // display this frame
+    m_shown_hash = hash;
+    m_t_shown = t_now;
+    m_stats.shown++;
+}
+
+uint8_t *leds_stream_buffer(uint16_t *size)
+{
+    *size = m_num_leds * sizeof(CRGB);
+    return (uint8_t *)m_back;
+}
+
+void leds_stream_commit(void)
+{
+    m_back_ready = true;
+}
+
+void leds_stream_discard(void)
+{
+    m_back_ready = false;
+}
+
+void leds_layers_begin(void)
+{
+    // The outgoing pattern carries on from what's on the strip now, and the
+    // incoming one starts from black
+    size_t size = m_num_leds * sizeof(CRGB);
+    memcpy(m_back, m_leds, size);
+    memset(m_layer, 0, size);
+    m_back_ready = false;
+    m_draw = m_leds;
+}
+
+void leds_layers_select(leds_layer_t layer)
+{
+    switch (layer)
+    {
+    case LEDS_LAYER_OUTGOING:
+        m_draw = m_back;
+        break;
+    case LEDS_LAYER_INCOMING:
+        m_draw = m_layer;
+        break;
+    default:
+        m_draw = m_leds;
+        break;
+    }
+}
+
+void leds_layers_blend(uint8_t amount)
+{
+    kernels_blend((uint8_t *)m_leds, (const uint8_t *)m_back, (const uint8_t *)m_layer,
+                  m_num_leds * sizeof(CRGB), amount);
+    m_draw = m_leds;
+}
+
+void leds_layers_end(void)
+{
+    // The incoming pattern's buffer becomes the strip, no copy needed
+    CRGB *front = m_layer;
+    m_layer = m_leds;
+    m_leds = front;
+    m_draw = front;
+    set_lengths(&m_config);
+}
+
+const leds_stats_t *leds_get_stats(void)
+{
+    return &m_stats;
 }
 
 /*----------------------------------------------------------------------------*/
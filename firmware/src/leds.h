@@ -15,20 +15,90 @@
 
 #include <stdint.h>
 
+/*---------------------------- Macros & Constants ----------------------------*/
+
+#define LEDS_MAX_STRIPS 4
+
 /*--------------------------------- Datatypes --------------------------------*/
 
+typedef struct
+{
+    uint8_t pin;
+    uint16_t length;
+} leds_strip_t;
+
+typedef struct
+{
+    uint8_t count;
+    leds_strip_t strips[LEDS_MAX_STRIPS];
+} leds_config_t;
+
+typedef enum
+{
+    LEDS_CONFIG_APPLIED,
+    LEDS_CONFIG_RESTART, // Valid, but pins changed so it applies after a reboot
+    LEDS_CONFIG_INVALID,
+} leds_config_result_t;
+
+// Everything a pattern may read: the same frame renders the same on every light
+typedef struct
+{
+    uint32_t t;          // Shared animation time, ms
+    uint32_t seed;       // Broadcast seed for random patterns
+    const uint8_t *cols; // Colour parameter, RGB
+} leds_frame_t;
+
+typedef enum
+{
+    LEDS_LAYER_FRONT,    // The strip itself
+    LEDS_LAYER_OUTGOING, // Pattern being faded out
+    LEDS_LAYER_INCOMING, // Pattern being faded in
+} leds_layer_t;
+
+typedef struct
+{
+    uint32_t shown;   // Frames sent to the strip
+    uint32_t skipped; // Frames identical to the last one sent
+} leds_stats_t;
+
 /*--------------------------------- Functions --------------------------------*/
 
-void leds_pattern_off(void);
-void leds_pattern_solid(uint8_t *cols);
-void leds_pattern_fire(void);
-void leds_pattern_sparkle(uint8_t *cols);
-void leds_pattern_calming(void);
-void leds_pattern_rainbow(void);
+// All patterns share one signature so they can sit in the registry
+void leds_pattern_off(const leds_frame_t *frame);
+void leds_pattern_solid(const leds_frame_t *frame);
+void leds_pattern_fire(const leds_frame_t *frame);
+void leds_pattern_sparkle(const leds_frame_t *frame);
+
+// Start hooks drop state left over from the last time a pattern ran
+void leds_pattern_fire_start(void);
+void leds_pattern_sparkle_start(void);
+void leds_pattern_calming(const leds_frame_t *frame);
+void leds_pattern_rainbow(const leds_frame_t *frame);
+void leds_pattern_stream(const leds_frame_t *frame);
+void leds_pattern_custom(const leds_frame_t *frame);
+void leds_pattern_music(const leds_frame_t *frame);
+void leds_pattern_music_start(void);
 
-void leds_initialise(void);
+void leds_default_config(leds_config_t *cfg);
+void leds_initialise(const leds_config_t *cfg);
+leds_config_result_t leds_configure(const leds_config_t *cfg);
+const leds_config_t *leds_get_config(void);
 void leds_render(void);
 
+// Raw RGB back buffer for streamed frames, swapped in by the Stream pattern
+uint8_t *leds_stream_buffer(uint16_t *size);
+void leds_stream_commit(void);
+void leds_stream_discard(void);
+
+// Transitions: patterns render into the outgoing and incoming layers, which
+// are blended onto the strip. Ending one makes the incoming layer the strip
+void leds_layers_begin(void);
+void leds_layers_select(leds_layer_t layer);
+void leds_layers_blend(uint8_t amount); // 0 = all outgoing, 255 = all incoming
+void leds_layers_end(void);
+
+const leds_stats_t *leds_get_stats(void);
+
 /*----------------------------------------------------------------------------*/
 
 #endif /* __FIRMWARE_SRC_LEDS_H__ */
@@ -15,49 +15,77 @@
 
 #include <ArduinoJson.h>
 #include <ESP8266WiFi.h>
-#include <PubSubClient.h>
 
+#include "clock.h"
+#include "commands.h"
+#include "config.h"
+#include "connection.h"
+#include "layout.h"
 #include "leds.h"
+#include "metrics.h"
+#include "patterns.h"
+#include "programs.h"
+#include "protocol.h"
+#include "sampler.h"
+#include "scheduler.h"
 #include "server.h"
+#include "stream.h"
+#include "transition.h"
 
 /*---------------------------- Macros & Constants ----------------------------*/
 
-/*----------------------------------- State ----------------------------------*/
+// State goes out as soon as it changes, at most this often while it's moving
+#define STATE_HOLDOFF_MS 250
+
+// Liveness only; the retained state topic carries everything else
+#define HEARTBEAT_MS 30000
 
-// MQTT Broker
-static const char *m_broker = "broker.emqx.io";
-static const char *m_broker_username = "emqx";
-static const char *m_broker_password = "public";
+/*----------------------------------- State ----------------------------------*/
 
 static const char *m_topic_command = "DIET-4073c85645649a02734/command";
-static const char *m_topic_discover = "DIET-4073c85645649a02734/discover";
 static const char *m_topic_state = "DIET-4073c85645649a02734/state";
-
-// Instances
-static WiFiClient m_espClient;
-static PubSubClient m_client(m_espClient);
-
-static char m_jsonBuf[512];
-
-static char m_mode[32] = "Solid";
+static const char *m_topic_clock = "DIET-4073c85645649a02734/clock";
+static const char *m_topic_metrics = "DIET-4073c85645649a02734/metrics";
+
+// Retained program uploads, one topic per program name. Only the selected
+// program's is followed, so lights don't keep every upload on flash
+static const char *m_prefix_program = "DIET-4073c85645649a02734/program/";
+static char m_topic_program[CONNECTION_TOPIC_SIZE]; // Empty with none selected
+
+// An upload waiting to be written from loop(), away from the MQTT client. One
+// byte over the largest image, so a longer one still fails verification
+static uint8_t m_pending_image[VM_MAX_IMAGE + 1];
+static unsigned int m_pending_length = 0;
+static bool m_pending = false;
+
+// Per-device topics, suffixed with our MAC
+static char m_topic_self[CONNECTION_TOPIC_SIZE];      // Retained state
+static char m_topic_heartbeat[CONNECTION_TOPIC_SIZE]; // Periodic STATE frame
+static char m_topic_direct[CONNECTION_TOPIC_SIZE];    // Commands for this light alone
+
+// Group topics, so the broker only sends us commands meant for us
+static char m_topic_groups[PROTOCOL_MAX_GROUPS][CONNECTION_TOPIC_SIZE];
+static uint8_t m_group_count = 0;
+
+// The state document is built here rather than on the 4 KB loop stack
+static StaticJsonDocument<1280> m_jsonDoc; // Around 64 values, 16 bytes each
+static char m_jsonBuf[CONNECTION_PAYLOAD_SIZE];
+
+static pattern_id_t m_mode = PATTERN_SOLID;
 static uint8_t m_colours[3] = {6, 15, 141};
 static bool m_enable = true; // Global lights override
 static bool m_lock = false;  // Global settings lock
+static uint16_t m_seq = 0;   // Sequence number of the last applied command
+static uint32_t m_seed = 0;  // Shared seed for random patterns
 
-/*------------------------------ Private Functions ---------------------------*/
-
-static void str_to_colour(const char *str, uint8_t *cols)
-{
-    // Assume string takes form #00FF00, etc... and is NULL-terminated
-    const char *ptr = &(str[1]);
-    int r, g, b; // Will be less than uint8_t
+static uint16_t m_metrics_s = 0;       // Metrics snapshot period, s (0 = off)
+static uint16_t m_fade_ms = 0;         // Crossfade time, ms (0 = cut)
+static uint32_t m_t_command = 0;       // When the last command was applied, us
+static bool m_command_pending = false; // Waiting for the frame that shows it
+static bool m_state_dirty = true;      // Retained state needs publishing
+static clock_beacon_t m_beacon;        // When we next stamp the clock topic
 
-    // NOTE this has no error handling!
-    sscanf(ptr, "%02x%02x%02x", &r, &g, &b);
-    cols[0] = r;
-    cols[1] = g;
-    cols[2] = b;
-}
+/*------------------------------ Private Functions ---------------------------*/
 
 static void colour_to_str(uint8_t *cols, char *dest)
 {
@@ -67,56 +95,445 @@ static void colour_to_str(uint8_t *cols, char *dest)
     sprintf(dest, "#%02x%02x%02x", cols[0], cols[1], cols[2]);
 }
 
-static void callback(char *topic, byte *payload, unsigned int length)
+static void restore_state(void)
+{
+    const config_t *cfg = config_get();
+    if (!cfg->has_state || cfg->mode >= PATTERN_COUNT)
+        return;
+
+    m_mode = (pattern_id_t)cfg->mode;
+    memcpy(m_colours, cfg->colour, sizeof(m_colours));
+    m_enable = cfg->enable;
+    m_lock = cfg->lock;
+    m_seed = cfg->seed;
+}
+
+static void restore_metrics(void)
+{
+    m_metrics_s = config_get()->metrics_s;
+}
+
+static void restore_fade(void)
+{
+    const config_t *cfg = config_get();
+    m_fade_ms = cfg->has_fade ? cfg->fade_ms : TRANSITION_DEFAULT_MS;
+    transition_set_duration(m_fade_ms);
+}
+
+static void restore_layout(void)
+{
+    layout_configure(&config_get()->layout);
+}
+
+static void save_state(void)
+{
+    config_t cfg = *config_get();
+    cfg.has_state = true;
+    cfg.mode = m_mode;
+    memcpy(cfg.colour, m_colours, sizeof(cfg.colour));
+    cfg.enable = m_enable;
+    cfg.lock = m_lock;
+    cfg.seed = m_seed;
+    config_set(&cfg);
+}
+
+static void subscribe_program(void)
+{
+    if (m_topic_program[0] != '\0')
+        connection_subscribe(m_topic_program);
+}
+
+static void program_topic(const char *name)
+{
+    m_topic_program[0] = '\0';
+    if (name[0] != '\0')
+        sprintf(m_topic_program, "%s%s", m_prefix_program, name);
+}
+
+static void restore_program(void)
+{
+    const config_t *cfg = config_get();
+    program_topic(cfg->program);
+    if (cfg->program[0] != '\0')
+        programs_load(cfg->program);
+}
+
+static void configure_program(const char *name)
+{
+    if (m_topic_program[0] != '\0')
+        connection_unsubscribe(m_topic_program);
+
+    config_t cfg = *config_get();
+    strcpy(cfg.program, name);
+    config_set(&cfg);
+
+    // Anything pending was for the old selection. Subscribing brings the
+    // retained image again; it may not have arrived yet, and is loaded when
+    // it does
+    m_pending = false;
+    program_topic(name);
+    subscribe_program();
+    programs_load(name);
+    scheduler_invalidate();
+    m_state_dirty = true;
+}
+
+static void configure_metrics(uint16_t period_s)
 {
-    StaticJsonDocument<256> doc;
-    deserializeJson(doc, payload);
+    m_metrics_s = period_s;
+    m_state_dirty = true;
 
-    const char *mode = doc["mode"];
-    const char *colour = doc["colour"];
+    config_t cfg = *config_get();
+    cfg.metrics_s = period_s;
+    config_set(&cfg);
+}
+
+static void configure_fade(uint16_t fade_ms)
+{
+    config_t cfg = *config_get();
+    cfg.has_fade = true;
+    cfg.fade_ms = fade_ms;
+    config_set(&cfg);
 
-    if (doc.containsKey("enable"))
+    restore_fade();
+    m_state_dirty = true;
+}
+
+static void configure_layout(const layout_config_t *layout)
+{
+    if (!layout_configure(layout))
+        return;
+
+    config_t cfg = *config_get();
+    cfg.layout = *layout;
+    config_set(&cfg);
+    scheduler_invalidate();
+}
+
+static void subscribe_groups(void)
+{
+    for (uint8_t i = 0; i < m_group_count; i++)
+        connection_subscribe(m_topic_groups[i]);
+}
+
+static void restore_groups(void)
+{
+    const config_t *cfg = config_get();
+    m_group_count = min(cfg->group_count, (uint8_t)PROTOCOL_MAX_GROUPS);
+    for (uint8_t i = 0; i < m_group_count; i++)
+        sprintf(m_topic_groups[i], "DIET-4073c85645649a02734/group/%s", cfg->groups[i]);
+}
+
+static void configure_groups(const protocol_command_t *cmd)
+{
+    for (uint8_t i = 0; i < m_group_count; i++)
+        connection_unsubscribe(m_topic_groups[i]);
+
+    config_t cfg = *config_get();
+    cfg.group_count = cmd->group_count;
+    memset(cfg.groups, 0, sizeof(cfg.groups));
+    memcpy(cfg.groups, cmd->groups, cmd->group_count * PROTOCOL_GROUP_SIZE);
+    config_set(&cfg);
+
+    restore_groups();
+    subscribe_groups();
+    m_state_dirty = true;
+}
+
+static void apply_changes(void)
+{
+    save_state();
+    scheduler_invalidate();
+    m_state_dirty = true;
+}
+
+static void configure_strips(const leds_config_t *cfg)
+{
+    leds_config_result_t result = leds_configure(cfg);
+    if (result == LEDS_CONFIG_INVALID)
+        return;
+
+    config_t stored = *config_get();
+    stored.strips = *cfg;
+    config_set(&stored);
+    scheduler_invalidate();
+    m_state_dirty = true;
+
+    if (result == LEDS_CONFIG_RESTART)
     {
-        bool enable = doc["enable"];
-        bool lock = doc["lock"];
+        config_flush();
+        ESP.restart();
+    }
+}
+
+static void apply_command(const protocol_command_t *cmd)
+{
+    if (cmd->fields & PROTOCOL_HAS_STRIPS)
+        configure_strips(&cmd->strips);
+
+    if (cmd->fields & PROTOCOL_HAS_LAYOUT)
+        configure_layout(&cmd->layout);
 
-        m_enable = enable;
-        m_lock = lock;
+    if (cmd->fields & PROTOCOL_HAS_METRICS)
+        configure_metrics(cmd->metrics_s);
+
+    if (cmd->fields & PROTOCOL_HAS_GROUPS)
+        configure_groups(cmd);
+
+    if (cmd->fields & PROTOCOL_HAS_FADE)
+        configure_fade(cmd->fade_ms);
+
+    if (cmd->fields & PROTOCOL_HAS_PROGRAM)
+        configure_program(cmd->program);
+
+    if (cmd->fields & PROTOCOL_HAS_OVERRIDE)
+    {
+        m_enable = cmd->enable;
+        m_lock = cmd->lock;
+        apply_changes();
     }
 
-    if (mode == nullptr) // Not for us
+    if (!(cmd->fields & PROTOCOL_HAS_MODE)) // Not for us
         return;
 
     if (!m_lock)
     {
-        strcpy(m_mode, mode); // Assumes no overflow
-        str_to_colour(colour, m_colours);
+        m_mode = cmd->mode;
+        if ((patterns_get(cmd->mode)->params & PATTERN_PARAM_COLOUR) && (cmd->fields & PROTOCOL_HAS_COLOUR))
+            memcpy(m_colours, cmd->colour, sizeof(m_colours));
+        if (cmd->fields & PROTOCOL_HAS_SEED)
+            m_seed = cmd->seed;
+        m_seq = cmd->seq;
+        apply_changes();
     }
+}
+
+static void apply_commands(void)
+{
+    protocol_command_t cmd;
+    while (commands_pop(&cmd))
+        apply_command(&cmd);
+}
+
+// Called mid connection_loop(), so the image is only copied; it's written to
+// flash by store_program(). Uploads still in flight from before a change of
+// program are dropped
+static void receive_program(const char *name, const uint8_t *image, unsigned int length)
+{
+    if (!protocol_valid_name(name) || strcmp(name, config_get()->program))
+        return;
 
-    // Serial.print("Message arrived in topic: ");
-    // Serial.println(topic);
-    // Serial.printf("Mode: %s\r\n", mode);
-    // Serial.printf("Colour: %s\r\n", colour);
-    // Serial.printf("Enable: %u\r\n", enable);
-    // Serial.printf("Lock: %u\r\n", lock);
-    // Serial.println();
+    m_pending_length = min(length, (unsigned int)sizeof(m_pending_image));
+    memcpy(m_pending_image, image, m_pending_length);
+    m_pending = true;
 }
 
-static void compose_json(void)
+static void store_program(void)
 {
-    StaticJsonDocument<256> doc;
+    if (!m_pending)
+        return;
+    m_pending = false;
 
-    doc["mac"] = WiFi.macAddress();
-    doc["ip"] = WiFi.localIP().toString();
-    doc["mode"] = m_mode;
+    // An update to the program we're running takes over straight away
+    const char *name = config_get()->program;
+    if (!programs_store(name, m_pending_image, m_pending_length))
+        return;
+
+    programs_load(name);
+    scheduler_invalidate();
+    m_state_dirty = true;
+}
+
+static void callback(char *topic, byte *payload, unsigned int length)
+{
+    // Program images are bytecode, not commands
+    size_t prefix = strlen(m_prefix_program);
+    if (!strncmp(topic, m_prefix_program, prefix))
+    {
+        receive_program(&topic[prefix], payload, length);
+        return;
+    }
+
+    // Accepts either JSON or the compact binary frame. JSON is parsed in
+    // place in the client's buffer, which is free to reuse once we return
+    protocol_command_t cmd;
+    if (!protocol_parse(payload, length, &cmd))
+        return;
+
+    // Any timestamped message keeps the animation clock in step
+    int32_t ahead = (cmd.fields & PROTOCOL_HAS_TIME) ? clock_sync(cmd.time) : 0;
+
+    if (cmd.type == PROTOCOL_TYPE_CLOCK)
+    {
+        clock_beacon_heard(&m_beacon, millis(), ahead, cmd.seq);
+        return;
+    }
+
+    // Nothing changes under a frame; the loop applies these between them
+    commands_push(&cmd);
+
+    // Command latency is measured from arrival up to the frame that shows it
+    if (!m_command_pending)
+    {
+        m_t_command = micros();
+        m_command_pending = true;
+    }
+}
+
+// False if the document doesn't fit, rather than publish it cut short
+static bool compose_json(void)
+{
+    JsonDocument &doc = m_jsonDoc;
+    doc.clear();
+
+    // Formatted in place: the String helpers allocate on every publish
+    uint8_t mac[6];
+    WiFi.macAddress(mac);
+    char mac_string[18];
+    sprintf(mac_string, "%02X:%02X:%02X:%02X:%02X:%02X",
+            mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+    doc["mac"] = (const char *)mac_string;
+
+    IPAddress ip = WiFi.localIP();
+    char ip_string[16];
+    sprintf(ip_string, "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+    doc["ip"] = (const char *)ip_string;
+    doc["mode"] = patterns_get(m_mode)->name;
 
     char col_string[16];
     colour_to_str(m_colours, col_string);
     doc["colour"] = col_string;
     doc["enable"] = m_enable;
     doc["lock"] = m_lock;
+    doc["seq"] = m_seq;
+    doc["seed"] = m_seed;
+    doc["metrics"] = m_metrics_s;
+    doc["fade"] = m_fade_ms;
+
+    const config_t *cfg = config_get();
+    doc["program"] = (const char *)cfg->program;
+
+    JsonArray groups = doc.createNestedArray("groups");
+    for (uint8_t i = 0; i < m_group_count; i++)
+        groups.add((const char *)cfg->groups[i]);
+
+    JsonArray modes = doc.createNestedArray("modes");
+    for (int i = 0; i < PATTERN_COUNT; i++)
+        modes.add(patterns_get((pattern_id_t)i)->name);
+
+    doc["reconnects"] = connection_get_reconnects();
+
+    const connection_boot_t *times = connection_get_boot();
+    JsonObject boot = doc.createNestedObject("boot");
+    boot["wifi"] = times->t_wifi;
+    boot["mqtt"] = times->t_subscribed;
+    boot["fast"] = times->fast;
+
+    const clock_stats_t *sync = clock_get_stats();
+    JsonObject clock = doc.createNestedObject("clock");
+    clock["t"] = clock_now();
+    clock["samples"] = sync->samples;
+    clock["adjustments"] = sync->adjustments;
+    clock["step"] = sync->last_step;
+
+    const leds_stats_t *frames = leds_get_stats();
+    JsonObject leds = doc.createNestedObject("leds");
+    leds["shown"] = frames->shown;
+    leds["skipped"] = frames->skipped;
+
+    const stream_stats_t *udp = stream_get_stats();
+    JsonObject stream = doc.createNestedObject("stream");
+    stream["frames"] = udp->frames;
+    stream["late"] = udp->late;
+    stream["invalid"] = udp->invalid;
+
+    const vm_stats_t *run = vm_get_stats();
+    JsonObject vm = doc.createNestedObject("vm");
+    vm["ops"] = run->ops;
+    vm["overruns"] = run->overruns;
+    vm["rejected"] = programs_get_stats()->rejected;
+
+    const commands_stats_t *queue = commands_get_stats();
+    JsonObject commands = doc.createNestedObject("commands");
+    commands["received"] = queue->received;
+    commands["coalesced"] = queue->coalesced;
+    commands["dropped"] = queue->dropped;
+
+    const scheduler_stats_t *stats = scheduler_get_stats();
+    JsonObject sched = doc.createNestedObject("sched");
+    sched["frames"] = stats->frames;
+    sched["skipped"] = stats->skipped;
+    JsonArray jitter = sched.createNestedArray("jitter");
+    for (int i = 0; i < SCHEDULER_JITTER_BUCKETS; i++)
+        jitter.add(stats->jitter[i]);
+
+    size_t length = measureJson(doc);
+    if (serializeJson(doc, m_jsonBuf) != length)
+    {
+        Serial.printf("State document of %u bytes doesn't fit\r\n", (unsigned)length);
+        return false;
+    }
+
+    return true;
+}
+
+static void publish_clock(void)
+{
+    protocol_command_t beacon;
+    memset(&beacon, 0, sizeof(beacon));
+    beacon.fields = PROTOCOL_HAS_TIME;
+    beacon.time = clock_now();
+    beacon.seq = m_beacon.nonce;
+
+    uint8_t frame[PROTOCOL_FRAME_SIZE];
+    unsigned int length = protocol_encode(PROTOCOL_TYPE_CLOCK, &beacon, frame);
+    connection_publish(m_topic_clock, frame, length);
+}
+
+static void publish_state(void)
+{
+    if (compose_json() && connection_publish(m_topic_self, m_jsonBuf, true))
+        m_state_dirty = false;
+}
+
+static void publish_heartbeat(void)
+{
+    // The same compact frame commands use, 18 bytes on the wire
+    protocol_command_t beat;
+    memset(&beat, 0, sizeof(beat));
+    beat.fields = PROTOCOL_HAS_MODE | PROTOCOL_HAS_COLOUR | PROTOCOL_HAS_OVERRIDE | PROTOCOL_HAS_TIME | PROTOCOL_HAS_SEED;
+    beat.mode = m_mode;
+    memcpy(beat.colour, m_colours, sizeof(beat.colour));
+    beat.enable = m_enable;
+    beat.lock = m_lock;
+    beat.seq = m_seq;
+    beat.time = clock_now();
+    beat.seed = m_seed;
+
+    uint8_t frame[PROTOCOL_FRAME_SIZE];
+    unsigned int length = protocol_encode(PROTOCOL_TYPE_STATE, &beat, frame);
+    connection_publish(m_topic_heartbeat, frame, length);
+}
+
+static void publish_metrics(void)
+{
+    static uint8_t snapshot[METRICS_SNAPSHOT_MAX];
+    unsigned int length = metrics_snapshot(snapshot);
+    connection_publish(m_topic_metrics, snapshot, length);
+}
 
-    serializeJson(doc, m_jsonBuf);
+static void on_online(void)
+{
+    // Subscribe to topic sets
+    connection_subscribe(m_topic_command);
+    connection_subscribe(m_topic_state);
+    connection_subscribe(m_topic_clock);
+    connection_subscribe(m_topic_direct);
+    subscribe_program();
+    subscribe_groups();
+
+    // The broker may have run our will since we were last here
+    m_state_dirty = true;
 }
 
 /*------------------------------- Public Functions ---------------------------*/
@@ -131,110 +548,124 @@ void setup()
     Serial.print("Device MAC Address: ");
     Serial.println(WiFi.macAddress());
 
-    leds_initialise();
     server_initialise();
 
+    // Strip layout comes from flash, falling back to a single default strip
+    const config_t *cfg = config_get();
+    leds_initialise(cfg->strips.count ? &cfg->strips : nullptr);
+
     /*------------------------------------------------------------------------*/
 
-    // Set to institute blue while connecting...
-    leds_pattern_solid(m_colours);
+    // Bring the last show straight back (institute blue on a first boot)
+    restore_state();
+    restore_metrics();
+    restore_fade();
+    restore_program();
+    restore_layout();
+    leds_frame_t frame = {clock_now(), m_seed, m_colours};
+    transition_render(m_enable ? m_mode : PATTERN_OFF, &frame, millis());
     leds_render();
 
-    Serial.printf("WiFi Credentials: %s, %s\r\n", server_get_ssid(), server_get_psk());
+    /*------------------------------------------------------------------------*/
 
-    // connect to the WiFi network
-    WiFi.begin(server_get_ssid(), server_get_psk());
+    uint8_t mac[6];
+    WiFi.macAddress(mac);
+    sprintf(m_topic_self, "DIET-4073c85645649a02734/state/%02X%02X%02X%02X%02X%02X",
+            mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+    sprintf(m_topic_heartbeat, "DIET-4073c85645649a02734/heartbeat/%02X%02X%02X%02X%02X%02X",
+            mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+    sprintf(m_topic_direct, "DIET-4073c85645649a02734/command/%02X%02X%02X%02X%02X%02X",
+            mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+    restore_groups();
+
+    // The MAC keeps lights' beacon timers from running in step
+    clock_beacon_start(&m_beacon, millis(), (mac[2] << 24) | (mac[3] << 16) | (mac[4] << 8) | mac[5]);
+
+    // Rendering carries on while the connection comes up in the background
+    connection_set_will(m_topic_self);
+    connection_initialise(callback, on_online);
+}
+
+void loop()
+{
     uint32_t t_now = millis();
-    while (WiFi.status() != WL_CONNECTED)
+    uint32_t t_start = micros();
+
+    connection_loop(t_now);
+    sampler_poll(micros());
+    config_loop(t_now);
+
+    // Everything that arrived since the last pass lands at once
+    apply_commands();
+    store_program();
+
+    // Each pattern runs at its own rate on a fixed grid, sped up to fade
+    static uint8_t rate = 0;
+    pattern_id_t id = m_enable ? m_mode : PATTERN_OFF;
+    uint8_t fps = patterns_get(id)->fps;
+    if (transition_active() && fps < TRANSITION_FPS)
+        fps = TRANSITION_FPS;
+    if (fps != rate)
     {
-        delay(500);
-        Serial.println("Connecting to WiFi...");
-        digitalWrite(LED_BUILTIN, !digitalRead(LED_BUILTIN));
-
-        if (millis() - t_now > 20000)
-        {
-            Serial.println("Could not connect - create soft AP");
-            server_launch_ap("GRADUATION-LIGHTS");
-            while (1)
-            {
-                server_loop();
-            }
-        }
+        scheduler_set_rate(fps, micros());
+        rate = fps;
     }
 
-    Serial.printf("Connected to the WiFi network: %s\r\n", server_get_ssid());
+    // The microphone is only sampled while Music is showing, and between the
+    // slow parts of a pass, as a frame takes several sample times
+    sampler_enable(id == PATTERN_MUSIC);
+    sampler_poll(micros());
 
-    /*------------------------------------------------------------------------*/
+    // Streamed frames go up as soon as they're complete, not on the next tick
+    stream_enable(id == PATTERN_STREAM);
+    if (stream_loop(t_now))
+        scheduler_invalidate();
 
-    // connecting to a mqtt broker
-    m_client.setServer(m_broker, 1883);
-    m_client.setCallback(callback);
-    while (!m_client.connected())
+    if (scheduler_poll(micros()))
     {
-        String client_id = "esp8266-client-";
-        client_id += String(WiFi.macAddress());
-        if (!m_client.connect(client_id.c_str(), m_broker_username, m_broker_password))
+        // Patterns only see shared time, so lights in a room stay in step
+        leds_frame_t frame = {clock_now(), m_seed, m_colours};
+        uint32_t t_render = micros();
+        transition_render(id, &frame, millis());
+        uint32_t t_show = micros();
+        metrics_record((metric_id_t)(METRIC_RENDER + id), t_show - t_render);
+        sampler_poll(t_show);
+        leds_render();
+        uint32_t t_shown = micros();
+        metrics_record(METRIC_SHOW, t_shown - t_show);
+        sampler_poll(t_shown);
+
+        if (m_command_pending)
         {
-            Serial.printf("Connection Failed! Code: %d", m_client.state());
-            digitalWrite(LED_BUILTIN, !digitalRead(LED_BUILTIN));
-            delay(2000);
+            metrics_record(METRIC_COMMAND, t_shown - m_t_command);
+            m_command_pending = false;
         }
-        delay(1000);
     }
 
-    digitalWrite(LED_BUILTIN, LOW);
-
-    /*------------------------------------------------------------------------*/
+    if (clock_beacon_due(&m_beacon, t_now))
+        publish_clock();
 
-    // Subscribe to topic sets
-    m_client.subscribe(m_topic_command);
-    m_client.subscribe(m_topic_state);
-}
-
-void loop()
-{
-    uint32_t t_now = millis();
-
-    m_client.loop();
-
-    static uint32_t t_render = 0;
-    if (t_now - t_render > 20)
+    // Retained state only goes out when something has changed
+    static uint32_t t_state = 0;
+    if (m_state_dirty && t_now - t_state >= STATE_HOLDOFF_MS)
     {
-        if (!strcmp(m_mode, "Off") || (m_enable == false))
-        {
-            leds_pattern_off();
-        }
-        else if (!strcmp(m_mode, "Solid"))
-        {
-            leds_pattern_solid(m_colours);
-        }
-        else if (!strcmp(m_mode, "Fire"))
-        {
-            leds_pattern_fire();
-        }
-        else if (!strcmp(m_mode, "Sparkle"))
-        {
-            leds_pattern_sparkle(m_colours);
-        }
-        else if (!strcmp(m_mode, "Calming"))
-        {
-            leds_pattern_calming();
-        }
-        else if (!strcmp(m_mode, "Rainbow"))
-        {
-            leds_pattern_rainbow();
-        }
+        publish_state();
+        t_state = t_now;
+    }
 
-        leds_render();
-        t_render = t_now;
+    static uint32_t t_heartbeat = 0;
+    if (t_now - t_heartbeat >= HEARTBEAT_MS)
+    {
+        publish_heartbeat();
+        t_heartbeat = t_now;
     }
 
-    // Publish to discovery channel every 5 seconds
-    static uint32_t t_dscvr = 0;
-    if (t_now - t_dscvr > 5000)
+    static uint32_t t_metrics = 0;
+    if (m_metrics_s && t_now - t_metrics >= (uint32_t)m_metrics_s * 1000)
     {
-        compose_json();
-        m_client.publish(m_topic_discover, m_jsonBuf);
-        t_dscvr = t_now;
+        publish_metrics();
+        t_metrics = t_now;
     }
+
+    metrics_record(METRIC_LOOP, micros() - t_start);
 }
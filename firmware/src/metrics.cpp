@@ -0,0 +1,108 @@
+/**
+ * @file metrics.cpp
+ * @author James Bennion-Pedley
+ * @brief Fixed-size timing histograms and health counters
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <Arduino.h>
+
+#include <ESP8266WiFi.h>
+
+#include "connection.h"
+#include "metrics.h"
+#include "protocol.h"
+
+/*--------------------------------- Datatypes --------------------------------*/
+
+typedef struct
+{
+    uint32_t count;
+    uint32_t max;
+    uint16_t buckets[METRICS_BUCKETS]; // Saturate rather than wrap
+} metrics_hist_t;
+
+/*----------------------------------- State ----------------------------------*/
+
+static metrics_hist_t m_hists[METRIC_COUNT];
+
+/*------------------------------ Private Functions ---------------------------*/
+
+static uint8_t *put_u32(uint8_t *dest, uint32_t value)
+{
+    dest[0] = value;
+    dest[1] = value >> 8;
+    dest[2] = value >> 16;
+    dest[3] = value >> 24;
+    return dest + 4;
+}
+
+static uint8_t *put_u16(uint8_t *dest, uint16_t value)
+{
+    dest[0] = value;
+    dest[1] = value >> 8;
+    return dest + 2;
+}
+
+/*------------------------------- Public Functions ---------------------------*/
+
+void metrics_record(metric_id_t id, uint32_t us)
+{
+    metrics_hist_t *h = &m_hists[id];
+
+    uint8_t bucket = (us == 0) ? 0 : 31 - __builtin_clz(us);
+    if (bucket >= METRICS_BUCKETS)
+        bucket = METRICS_BUCKETS - 1;
+
+    if (h->buckets[bucket] != UINT16_MAX)
+        h->buckets[bucket]++;
+    h->count++;
+    if (us > h->max)
+        h->max = us;
+}
+
+unsigned int metrics_snapshot(uint8_t *dest)
+{
+    // Destination should be at least METRICS_SNAPSHOT_MAX bytes long!
+    uint8_t *p = dest;
+
+    *p++ = PROTOCOL_MAGIC;
+    *p++ = METRICS_VERSION;
+    *p++ = METRICS_TYPE;
+    *p++ = 0; // Histogram count, filled in below
+
+    WiFi.macAddress(p);
+    p += WL_MAC_ADDR_LENGTH;
+    p = put_u32(p, millis());
+    p = put_u32(p, ESP.getFreeHeap());
+    p = put_u32(p, ESP.getMaxFreeBlockSize());
+    *p++ = ESP.getHeapFragmentation();
+    *p++ = 0;
+    p = put_u32(p, connection_get_reconnects());
+
+    for (uint8_t id = 0; id < METRIC_COUNT; id++)
+    {
+        metrics_hist_t *h = &m_hists[id];
+        if (h->count == 0)
+            continue;
+
+        *p++ = id;
+        p = put_u32(p, h->count);
+        p = put_u32(p, h->max);
+        for (uint8_t b = 0; b < METRICS_BUCKETS; b++)
+            p = put_u16(p, h->buckets[b]);
+
+        dest[3]++;
+    }
+
+    memset(m_hists, 0, sizeof(m_hists));
+
+    return p - dest;
+}
+
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,60 @@
+/**
+ * @file metrics.h
+ * @author James Bennion-Pedley
+ * @brief Fixed-size timing histograms and health counters
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef __FIRMWARE_SRC_METRICS_H__
+#define __FIRMWARE_SRC_METRICS_H__
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <stdint.h>
+
+#include "patterns.h"
+
+/*---------------------------- Macros & Constants ----------------------------*/
+
+// Bucket i counts durations in [2^i, 2^(i+1)) us; the last one is open-ended
+#define METRICS_BUCKETS 16
+
+// Snapshot, version 1 (multi-byte fields little-endian):
+//   [0] magic  [1] version  [2] type  [3] histogram count
+//   [4..9] MAC  [10..13] uptime, ms  [14..17] free heap  [18..21] largest
+//   free block  [22] heap fragmentation, %  [23] reserved  [24..27] reconnects
+// then for each non-empty histogram since the last snapshot:
+//   [0] metric id  [1..4] count  [5..8] max, us  [9..] METRICS_BUCKETS x u16
+// Shares its first bytes with protocol.h frames, so one decoder can tell them apart
+#define METRICS_VERSION 1
+#define METRICS_TYPE 4
+#define METRICS_HEADER_SIZE 28
+#define METRICS_HIST_SIZE (9 + 2 * METRICS_BUCKETS)
+
+/*--------------------------------- Datatypes --------------------------------*/
+
+typedef enum
+{
+    METRIC_LOOP,      // One pass of loop()
+    METRIC_SHOW,      // leds_render(), including skipped frames
+    METRIC_MQTT_LOOP, // PubSubClient::loop(), including message callbacks
+    METRIC_COMMAND,   // Command received to its first frame shown
+    METRIC_RENDER,    // Pattern render times, one per pattern from here
+    METRIC_COUNT = METRIC_RENDER + PATTERN_COUNT,
+} metric_id_t;
+
+#define METRICS_SNAPSHOT_MAX (METRICS_HEADER_SIZE + METRIC_COUNT * METRICS_HIST_SIZE)
+
+/*--------------------------------- Functions --------------------------------*/
+
+void metrics_record(metric_id_t id, uint32_t us);
+
+// Encodes everything since the last snapshot into dest, then starts afresh
+unsigned int metrics_snapshot(uint8_t *dest);
+
+/*----------------------------------------------------------------------------*/
+
+#endif /* __FIRMWARE_SRC_METRICS_H__ */
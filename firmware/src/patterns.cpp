@@ -0,0 +1,60 @@
+/**
+ * @file patterns.cpp
+ * @author James Bennion-Pedley
+ * @brief Pattern Registry
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <string.h>
+
+#include "patterns.h"
+
+/*----------------------------------- State ----------------------------------*/
+
+static const pattern_t m_patterns[PATTERN_COUNT] = {
+#define PATTERN_ENTRY(id, name, render, start, params, fps) {name, render, start, params, fps},
+    PATTERN_LIST(PATTERN_ENTRY)
+#undef PATTERN_ENTRY
+};
+
+/*------------------------------- Public Functions ---------------------------*/
+
+pattern_id_t patterns_find(const char *name)
+{
+    if (name == nullptr)
+        return PATTERN_COUNT;
+
+    for (int i = 0; i < PATTERN_COUNT; i++)
+    {
+        if (!strcmp(name, m_patterns[i].name))
+            return (pattern_id_t)i;
+    }
+
+    return PATTERN_COUNT;
+}
+
+const pattern_t *patterns_get(pattern_id_t id)
+{
+    if (id >= PATTERN_COUNT)
+        return nullptr;
+
+    return &m_patterns[id];
+}
+
+void patterns_start(pattern_id_t id)
+{
+    if (m_patterns[id].start != nullptr)
+        m_patterns[id].start();
+}
+
+void patterns_render(pattern_id_t id, const leds_frame_t *frame)
+{
+    m_patterns[id].render(frame);
+}
+
+/*----------------------------------------------------------------------------*/
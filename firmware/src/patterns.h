@@ -0,0 +1,70 @@
+/**
+ * @file patterns.h
+ * @author James Bennion-Pedley
+ * @brief Pattern Registry
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef __FIRMWARE_SRC_PATTERNS_H__
+#define __FIRMWARE_SRC_PATTERNS_H__
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <stdint.h>
+
+#include "leds.h"
+
+/*---------------------------- Macros & Constants ----------------------------*/
+
+// Parameters a pattern reads from a command
+#define PATTERN_PARAM_NONE 0
+#define PATTERN_PARAM_COLOUR (1 << 0)
+
+// Adding a pattern is one line here: id, mode name, render, start hook (or
+// nullptr), params, default fps
+// Ids are sent in binary commands, so new patterns go on the end
+// Static patterns tick over at 1 fps; commands (and streamed frames) trigger
+// an immediate frame
+#define PATTERN_LIST(X)                                                                                  \
+    X(PATTERN_OFF, "Off", leds_pattern_off, nullptr, PATTERN_PARAM_NONE, 1)                              \
+    X(PATTERN_SOLID, "Solid", leds_pattern_solid, nullptr, PATTERN_PARAM_COLOUR, 1)                      \
+    X(PATTERN_FIRE, "Fire", leds_pattern_fire, leds_pattern_fire_start, PATTERN_PARAM_NONE, 50)          \
+    X(PATTERN_SPARKLE, "Sparkle", leds_pattern_sparkle, leds_pattern_sparkle_start, PATTERN_PARAM_COLOUR, 50) \
+    X(PATTERN_CALMING, "Calming", leds_pattern_calming, nullptr, PATTERN_PARAM_NONE, 60)                 \
+    X(PATTERN_RAINBOW, "Rainbow", leds_pattern_rainbow, nullptr, PATTERN_PARAM_NONE, 60)                 \
+    X(PATTERN_STREAM, "Stream", leds_pattern_stream, nullptr, PATTERN_PARAM_NONE, 1)                     \
+    X(PATTERN_CUSTOM, "Custom", leds_pattern_custom, nullptr, PATTERN_PARAM_COLOUR, 50)                  \
+    X(PATTERN_MUSIC, "Music", leds_pattern_music, leds_pattern_music_start, PATTERN_PARAM_COLOUR, 50)
+
+/*--------------------------------- Datatypes --------------------------------*/
+
+typedef enum
+{
+#define PATTERN_ENUM(id, name, render, start, params, fps) id,
+    PATTERN_LIST(PATTERN_ENUM)
+#undef PATTERN_ENUM
+    PATTERN_COUNT, // Also returned for unknown modes
+} pattern_id_t;
+
+typedef struct
+{
+    const char *name;
+    void (*render)(const leds_frame_t *frame);
+    void (*start)(void);
+    uint8_t params;
+    uint8_t fps;
+} pattern_t;
+
+/*--------------------------------- Functions --------------------------------*/
+
+pattern_id_t patterns_find(const char *name);
+const pattern_t *patterns_get(pattern_id_t id);
+void patterns_start(pattern_id_t id);
+void patterns_render(pattern_id_t id, const leds_frame_t *frame);
+
+/*----------------------------------------------------------------------------*/
+
+#endif /* __FIRMWARE_SRC_PATTERNS_H__ */
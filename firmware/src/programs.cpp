@@ -0,0 +1,112 @@
+/**
+ * @file programs.cpp
+ * @author James Bennion-Pedley
+ * @brief Pattern programs kept on flash
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <Arduino.h>
+
+#include <LittleFS.h>
+
+#include "programs.h"
+#include "sampler.h"
+
+/*----------------------------------- State ----------------------------------*/
+
+// Verified copy being installed or stored; too big for the stack
+static vm_program_t m_program;
+static uint8_t m_image[VM_MAX_IMAGE];
+
+static programs_stats_t m_stats;
+
+/*------------------------------ Private Functions ---------------------------*/
+
+static void program_path(const char *name, char *dest)
+{
+    sprintf(dest, "/vm/%s", name);
+}
+
+static unsigned int read_image(const char *path, uint8_t *dest)
+{
+    File f = LittleFS.open(path, "r");
+    if (!f)
+        return 0;
+
+    unsigned int length = f.read(dest, VM_MAX_IMAGE);
+    f.close();
+    return length;
+}
+
+/*------------------------------- Public Functions ---------------------------*/
+
+bool programs_store(const char *name, const uint8_t *image, unsigned int length)
+{
+    char path[32];
+    program_path(name, path);
+
+    if (length == 0)
+    {
+        sampler_pause(true);
+        bool ok = LittleFS.remove(path);
+        sampler_pause(false);
+        return ok;
+    }
+
+    vm_result_t result = vm_verify(image, length, &m_program);
+    if (result != VM_OK)
+    {
+        m_stats.rejected++;
+        m_stats.last_error = result;
+        return false;
+    }
+
+    // Uploads are retained, so every reconnect sends them again
+    if (read_image(path, m_image) == length && !memcmp(m_image, image, length))
+        return true;
+
+    // Written aside and renamed, so a cut-short write leaves the old one
+    char temp[36];
+    sprintf(temp, "%s.new", path);
+    sampler_pause(true);
+    File f = LittleFS.open(temp, "w");
+    bool ok = f && f.write(image, length) == length;
+    if (f)
+        f.close();
+
+    if (ok)
+    {
+        LittleFS.remove(path);
+        ok = LittleFS.rename(temp, path);
+    }
+    sampler_pause(false);
+
+    if (ok)
+        m_stats.stored++;
+    return ok;
+}
+
+bool programs_load(const char *name)
+{
+    char path[32];
+    program_path(name, path);
+
+    // Flash can rot, so it's verified again on the way in
+    unsigned int length = read_image(path, m_image);
+    bool ok = length > 0 && vm_verify(m_image, length, &m_program) == VM_OK;
+
+    vm_install(ok ? &m_program : nullptr);
+    return ok;
+}
+
+const programs_stats_t *programs_get_stats(void)
+{
+    return &m_stats;
+}
+
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,43 @@
+/**
+ * @file programs.h
+ * @author James Bennion-Pedley
+ * @brief Pattern programs kept on flash
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef __FIRMWARE_SRC_PROGRAMS_H__
+#define __FIRMWARE_SRC_PROGRAMS_H__
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <stdint.h>
+
+#include "vm.h"
+
+/*--------------------------------- Datatypes --------------------------------*/
+
+typedef struct
+{
+    uint32_t stored;        // Uploads written to flash
+    uint32_t rejected;      // Uploads that failed verification
+    vm_result_t last_error; // Why the last one was rejected
+} programs_stats_t;
+
+/*--------------------------------- Functions --------------------------------*/
+
+// Needs LittleFS mounted. Images are verified before they're written, and
+// an empty one removes the program
+bool programs_store(const char *name, const uint8_t *image, unsigned int length);
+
+// Installs the named program for the Custom pattern, or none if it isn't
+// stored (yet)
+bool programs_load(const char *name);
+
+const programs_stats_t *programs_get_stats(void);
+
+/*----------------------------------------------------------------------------*/
+
+#endif /* __FIRMWARE_SRC_PROGRAMS_H__ */
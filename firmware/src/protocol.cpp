@@ -0,0 +1,348 @@
+/**
+ * @file protocol.cpp
+ * @author James Bennion-Pedley
+ * @brief Command parsing for the JSON and compact binary formats
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <string.h>
+
+#include <ArduinoJson.h>
+
+#include "protocol.h"
+
+/*------------------------------ Private Functions ---------------------------*/
+
+static int8_t hex_nibble(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+static uint32_t read_u32(const uint8_t *src)
+{
+    return src[0] | (src[1] << 8) | (src[2] << 16) | ((uint32_t)src[3] << 24);
+}
+
+static void write_u32(uint8_t *dest, uint32_t value)
+{
+    dest[0] = value;
+    dest[1] = value >> 8;
+    dest[2] = value >> 16;
+    dest[3] = value >> 24;
+}
+
+static void parse_strips(JsonArrayConst strips, protocol_command_t *cmd)
+{
+    // Takes the form [{"pin": 0, "length": 300}, ...]
+    if (strips.size() == 0 || strips.size() > LEDS_MAX_STRIPS)
+        return;
+
+    leds_config_t *cfg = &cmd->strips;
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->count = strips.size();
+    for (uint8_t i = 0; i < cfg->count; i++)
+    {
+        cfg->strips[i].pin = strips[i]["pin"] | 0xFF;
+        cfg->strips[i].length = strips[i]["length"] | 0;
+    }
+
+    cmd->fields |= PROTOCOL_HAS_STRIPS;
+}
+
+static void parse_layout(JsonObjectConst layout, protocol_command_t *cmd)
+{
+    // Takes the form {"matrix": [16, 16], "serpentine": true}, with
+    // "vertical", "flip_x" and "flip_y" also optional, or {"rings": [24, 16,
+    // 8, 1]}. Anything else is a plain strip
+    layout_config_t *cfg = &cmd->layout;
+    memset(cfg, 0, sizeof(*cfg));
+
+    JsonArrayConst matrix = layout["matrix"];
+    JsonArrayConst rings = layout["rings"];
+    if (!matrix.isNull())
+    {
+        uint16_t width = matrix[0] | 0;
+        uint16_t height = matrix[1] | 0;
+        if (matrix.size() != 2 || width > 255 || height > 255)
+            return;
+
+        cfg->type = LAYOUT_MATRIX;
+        cfg->width = width;
+        cfg->height = height;
+        cfg->flags = ((layout["serpentine"] | false) ? LAYOUT_SERPENTINE : 0) |
+                     ((layout["vertical"] | false) ? LAYOUT_VERTICAL : 0) |
+                     ((layout["flip_x"] | false) ? LAYOUT_FLIP_X : 0) |
+                     ((layout["flip_y"] | false) ? LAYOUT_FLIP_Y : 0);
+    }
+    else if (!rings.isNull())
+    {
+        if (rings.size() > LAYOUT_MAX_RINGS)
+            return;
+
+        cfg->type = LAYOUT_RINGS;
+        for (uint8_t i = 0; i < rings.size(); i++)
+        {
+            uint16_t count = rings[i] | 0;
+            if (count == 0 || count > 255)
+                return;
+            cfg->rings[i] = count;
+        }
+    }
+
+    if (layout_valid(cfg))
+        cmd->fields |= PROTOCOL_HAS_LAYOUT;
+}
+
+static void parse_groups(JsonArrayConst groups, protocol_command_t *cmd)
+{
+    // Takes the form ["stage", "table-3"]; an empty list leaves every group
+    if (groups.isNull() || groups.size() > PROTOCOL_MAX_GROUPS)
+        return;
+
+    for (uint8_t i = 0; i < groups.size(); i++)
+    {
+        const char *name = groups[i];
+        if (!protocol_valid_name(name))
+            return;
+        strcpy(cmd->groups[i], name);
+    }
+
+    cmd->group_count = groups.size();
+    cmd->fields |= PROTOCOL_HAS_GROUPS;
+}
+
+/*------------------------------- Public Functions ---------------------------*/
+
+bool protocol_str_to_colour(const char *str, uint8_t *cols)
+{
+    // Takes the form #00FF00; anything else is rejected
+    if (str == nullptr || str[0] != '#' || strlen(str) != 7)
+        return false;
+
+    uint8_t parsed[3];
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        int8_t hi = hex_nibble(str[1 + 2 * i]);
+        int8_t lo = hex_nibble(str[2 + 2 * i]);
+        if (hi < 0 || lo < 0)
+            return false;
+        parsed[i] = (hi << 4) | lo;
+    }
+
+    memcpy(cols, parsed, sizeof(parsed));
+    return true;
+}
+
+bool protocol_valid_name(const char *name)
+{
+    // Names end up in topics and file names, so no separators or wildcards
+    if (name == nullptr)
+        return false;
+
+    size_t length = strlen(name);
+    if (length == 0 || length >= PROTOCOL_GROUP_SIZE)
+        return false;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        char c = name[i];
+        bool ok = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                  (c >= '0' && c <= '9') || c == '-' || c == '_';
+        if (!ok)
+            return false;
+    }
+    return true;
+}
+
+bool protocol_parse(uint8_t *payload, unsigned int length, protocol_command_t *cmd)
+{
+    if (length == 0)
+        return false;
+
+    if (payload[0] == PROTOCOL_MAGIC)
+        return protocol_parse_binary(payload, length, cmd);
+
+    return protocol_parse_json(payload, length, cmd);
+}
+
+bool protocol_parse_json(uint8_t *payload, unsigned int length, protocol_command_t *cmd)
+{
+    // A mutable input puts ArduinoJson in zero-copy mode: strings stay in
+    // the payload, so the document only holds the tree
+    StaticJsonDocument<512> doc;
+    if (deserializeJson(doc, (char *)payload, length))
+        return false;
+
+    memset(cmd, 0, sizeof(*cmd));
+    cmd->type = PROTOCOL_TYPE_COMMAND;
+
+    const char *mode = doc["mode"];
+    if (mode != nullptr)
+    {
+        // Resolve the mode once here so each frame is a single indexed call
+        cmd->mode = patterns_find(mode);
+        if (cmd->mode != PATTERN_COUNT)
+            cmd->fields |= PROTOCOL_HAS_MODE;
+    }
+
+    if (protocol_str_to_colour(doc["colour"], cmd->colour))
+        cmd->fields |= PROTOCOL_HAS_COLOUR;
+
+    if (doc.containsKey("enable"))
+    {
+        cmd->enable = doc["enable"];
+        cmd->lock = doc["lock"];
+        cmd->fields |= PROTOCOL_HAS_OVERRIDE;
+    }
+
+    if (doc.containsKey("strips"))
+        parse_strips(doc["strips"], cmd);
+
+    if (doc.containsKey("layout"))
+        parse_layout(doc["layout"], cmd);
+
+    if (doc.containsKey("t"))
+    {
+        cmd->time = doc["t"];
+        cmd->fields |= PROTOCOL_HAS_TIME;
+    }
+
+    if (doc.containsKey("seed"))
+    {
+        cmd->seed = doc["seed"];
+        cmd->fields |= PROTOCOL_HAS_SEED;
+    }
+
+    if (doc.containsKey("metrics"))
+    {
+        cmd->metrics_s = doc["metrics"];
+        cmd->fields |= PROTOCOL_HAS_METRICS;
+    }
+
+    if (doc.containsKey("fade"))
+    {
+        cmd->fade_ms = doc["fade"];
+        cmd->fields |= PROTOCOL_HAS_FADE;
+    }
+
+    if (doc.containsKey("groups"))
+        parse_groups(doc["groups"], cmd);
+
+    const char *program = doc["program"];
+    if (protocol_valid_name(program))
+    {
+        strcpy(cmd->program, program);
+        cmd->fields |= PROTOCOL_HAS_PROGRAM;
+    }
+
+    cmd->seq = doc["seq"] | 0;
+
+    return cmd->fields != 0;
+}
+
+bool protocol_parse_binary(const uint8_t *payload, unsigned int length, protocol_command_t *cmd)
+{
+    // Later versions may append fields, but never move these ones
+    if (length < PROTOCOL_FRAME_SIZE_V1 || payload[0] != PROTOCOL_MAGIC)
+        return false;
+
+    uint8_t version = payload[1];
+    if (version < 1 || version > PROTOCOL_VERSION)
+        return false;
+    if (version >= 2 && length < PROTOCOL_FRAME_SIZE)
+        return false;
+
+    if (payload[2] != PROTOCOL_TYPE_COMMAND && payload[2] != PROTOCOL_TYPE_CLOCK)
+        return false;
+
+    memset(cmd, 0, sizeof(*cmd));
+    cmd->type = payload[2];
+
+    // Version 1 frames have no time or seed, so ignore those flags
+    uint8_t flags = payload[3];
+    if (version < 2)
+        flags &= ~(PROTOCOL_FLAG_TIME | PROTOCOL_FLAG_SEED);
+
+    if ((flags & PROTOCOL_FLAG_MODE) && payload[4] < PATTERN_COUNT)
+    {
+        cmd->mode = (pattern_id_t)payload[4];
+        cmd->fields |= PROTOCOL_HAS_MODE;
+    }
+
+    if (flags & PROTOCOL_FLAG_COLOUR)
+    {
+        memcpy(cmd->colour, &payload[5], 3);
+        cmd->fields |= PROTOCOL_HAS_COLOUR;
+    }
+
+    if (flags & PROTOCOL_FLAG_OVERRIDE)
+    {
+        cmd->enable = flags & PROTOCOL_FLAG_ENABLE;
+        cmd->lock = flags & PROTOCOL_FLAG_LOCK;
+        cmd->fields |= PROTOCOL_HAS_OVERRIDE;
+    }
+
+    if (flags & PROTOCOL_FLAG_TIME)
+    {
+        cmd->time = read_u32(&payload[10]);
+        cmd->fields |= PROTOCOL_HAS_TIME;
+    }
+
+    if (flags & PROTOCOL_FLAG_SEED)
+    {
+        cmd->seed = read_u32(&payload[14]);
+        cmd->fields |= PROTOCOL_HAS_SEED;
+    }
+
+    cmd->seq = payload[8] | (payload[9] << 8);
+
+    return cmd->fields != 0;
+}
+
+unsigned int protocol_encode(uint8_t type, const protocol_command_t *cmd, uint8_t *dest)
+{
+    // Destination should be at least PROTOCOL_FRAME_SIZE bytes long!
+    uint8_t flags = 0;
+    if (cmd->fields & PROTOCOL_HAS_MODE)
+        flags |= PROTOCOL_FLAG_MODE;
+    if (cmd->fields & PROTOCOL_HAS_COLOUR)
+        flags |= PROTOCOL_FLAG_COLOUR;
+    if (cmd->fields & PROTOCOL_HAS_OVERRIDE)
+    {
+        flags |= PROTOCOL_FLAG_OVERRIDE;
+        if (cmd->enable)
+            flags |= PROTOCOL_FLAG_ENABLE;
+        if (cmd->lock)
+            flags |= PROTOCOL_FLAG_LOCK;
+    }
+    if (cmd->fields & PROTOCOL_HAS_TIME)
+        flags |= PROTOCOL_FLAG_TIME;
+    if (cmd->fields & PROTOCOL_HAS_SEED)
+        flags |= PROTOCOL_FLAG_SEED;
+
+    dest[0] = PROTOCOL_MAGIC;
+    dest[1] = PROTOCOL_VERSION;
+    dest[2] = type;
+    dest[3] = flags;
+    dest[4] = (cmd->fields & PROTOCOL_HAS_MODE) ? cmd->mode : 0xFF;
+    memcpy(&dest[5], cmd->colour, 3);
+    dest[8] = cmd->seq & 0xFF;
+    dest[9] = cmd->seq >> 8;
+    write_u32(&dest[10], cmd->time);
+    write_u32(&dest[14], cmd->seed);
+
+    return PROTOCOL_FRAME_SIZE;
+}
+
+/*----------------------------------------------------------------------------*/
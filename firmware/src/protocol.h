@@ -0,0 +1,107 @@
+/**
+ * @file protocol.h
+ * @author James Bennion-Pedley
+ * @brief Command parsing for the JSON and compact binary formats
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef __FIRMWARE_SRC_PROTOCOL_H__
+#define __FIRMWARE_SRC_PROTOCOL_H__
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <stdint.h>
+
+#include "layout.h"
+#include "leds.h"
+#include "patterns.h"
+
+/*---------------------------- Macros & Constants ----------------------------*/
+
+// Binary frame, version 2 (multi-byte fields little-endian):
+//   [0] magic  [1] version  [2] type  [3] flags  [4] mode id
+//   [5] red  [6] green  [7] blue  [8..9] sequence number
+//   [10..13] shared time, ms  [14..17] random seed
+// Version 1 frames stop after the sequence number and are still accepted.
+// JSON always starts with '{' or whitespace, so the magic byte can't collide
+#define PROTOCOL_MAGIC 0xA5
+#define PROTOCOL_VERSION 2
+#define PROTOCOL_FRAME_SIZE 18
+#define PROTOCOL_FRAME_SIZE_V1 10
+
+#define PROTOCOL_TYPE_COMMAND 1
+#define PROTOCOL_TYPE_STATE 2
+#define PROTOCOL_TYPE_CLOCK 3 // Time beacon between lights, no command fields
+
+// Named groups a light listens on, as group/<name> topics
+#define PROTOCOL_MAX_GROUPS 4
+#define PROTOCOL_GROUP_SIZE 17 // 16 characters, plus terminator
+
+// Stored pattern programs are named the same way, as program/<name> topics
+#define PROTOCOL_PROGRAM_SIZE 17
+
+// Frame flags
+#define PROTOCOL_FLAG_MODE (1 << 0)     // Mode id is valid
+#define PROTOCOL_FLAG_COLOUR (1 << 1)   // RGB is valid
+#define PROTOCOL_FLAG_OVERRIDE (1 << 2) // Enable and lock bits are valid
+#define PROTOCOL_FLAG_ENABLE (1 << 3)
+#define PROTOCOL_FLAG_LOCK (1 << 4)
+#define PROTOCOL_FLAG_TIME (1 << 5) // Sender's shared time is valid
+#define PROTOCOL_FLAG_SEED (1 << 6) // Seed is valid
+
+// Parsed command fields
+#define PROTOCOL_HAS_MODE (1 << 0)
+#define PROTOCOL_HAS_COLOUR (1 << 1)
+#define PROTOCOL_HAS_OVERRIDE (1 << 2)
+#define PROTOCOL_HAS_STRIPS (1 << 3)
+#define PROTOCOL_HAS_TIME (1 << 4)
+#define PROTOCOL_HAS_SEED (1 << 5)
+#define PROTOCOL_HAS_METRICS (1 << 6)
+#define PROTOCOL_HAS_GROUPS (1 << 7)
+#define PROTOCOL_HAS_FADE (1 << 8)
+#define PROTOCOL_HAS_PROGRAM (1 << 9)
+#define PROTOCOL_HAS_LAYOUT (1 << 10)
+
+/*--------------------------------- Datatypes --------------------------------*/
+
+typedef struct
+{
+    uint8_t type;   // PROTOCOL_TYPE_*, JSON is always a command
+    uint16_t fields; // PROTOCOL_HAS_*
+    pattern_id_t mode;
+    uint8_t colour[3];
+    bool enable;
+    bool lock;
+    uint16_t seq;
+    uint32_t time;
+    uint32_t seed;
+    uint16_t metrics_s; // Metrics snapshot period, 0 = off
+    uint16_t fade_ms;   // Transition time, 0 = cut
+    uint8_t group_count;
+    char groups[PROTOCOL_MAX_GROUPS][PROTOCOL_GROUP_SIZE];
+    char program[PROTOCOL_PROGRAM_SIZE]; // Run by the Custom pattern
+    leds_config_t strips;
+    layout_config_t layout;
+} protocol_command_t;
+
+/*--------------------------------- Functions --------------------------------*/
+
+// JSON is parsed in place without copying strings, so the payload is
+// modified. Binary frames are only read
+bool protocol_parse(uint8_t *payload, unsigned int length, protocol_command_t *cmd);
+bool protocol_parse_json(uint8_t *payload, unsigned int length, protocol_command_t *cmd);
+bool protocol_parse_binary(const uint8_t *payload, unsigned int length, protocol_command_t *cmd);
+
+unsigned int protocol_encode(uint8_t type, const protocol_command_t *cmd, uint8_t *dest);
+
+bool protocol_str_to_colour(const char *str, uint8_t *cols);
+
+// Group and program names: 1-16 of [A-Za-z0-9_-]
+bool protocol_valid_name(const char *name);
+
+/*----------------------------------------------------------------------------*/
+
+#endif /* __FIRMWARE_SRC_PROTOCOL_H__ */
@@ -0,0 +1,72 @@
+/**
+ * @file sampler.cpp
+ * @author James Bennion-Pedley
+ * @brief Fixed-rate A0 sampling into the audio ring
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <Arduino.h>
+
+#include "audio.h"
+#include "sampler.h"
+
+/*---------------------------- Macros & Constants ----------------------------*/
+
+#define SAMPLER_PERIOD_US (1000000 / AUDIO_SAMPLE_HZ)
+
+// The most missed sample times one late poll fills; a longer stall (a slow
+// broker, say) is skipped over rather than spread across whole blocks
+#define SAMPLER_MAX_CATCH_UP AUDIO_BLOCK
+
+/*----------------------------------- State ----------------------------------*/
+
+static bool m_enabled = false;
+static bool m_paused = false;
+static uint32_t m_t_next = 0; // When the next sample is due, us
+
+/*------------------------------ Private Functions ---------------------------*/
+
+static void restart(void)
+{
+    m_t_next = micros();
+}
+
+/*------------------------------- Public Functions ---------------------------*/
+
+void sampler_enable(bool enable)
+{
+    if (enable == m_enabled)
+        return;
+    m_enabled = enable;
+
+    if (enable)
+        restart();
+}
+
+void sampler_pause(bool pause)
+{
+    m_paused = pause;
+    if (!pause)
+        restart();
+}
+
+void sampler_poll(uint32_t t_now)
+{
+    int32_t late = t_now - m_t_next;
+    if (!m_enabled || m_paused || late < 0)
+        return;
+
+    // Sample times missed while loop() was busy with a frame are filled in
+    // up to this reading. Beats stay on time; what's lost is detail faster
+    // than the gap
+    uint32_t due = late / SAMPLER_PERIOD_US + 1;
+    audio_push_late(analogRead(A0), (due < SAMPLER_MAX_CATCH_UP) ? due : SAMPLER_MAX_CATCH_UP);
+    m_t_next += due * SAMPLER_PERIOD_US;
+}
+
+/*----------------------------------------------------------------------------*/
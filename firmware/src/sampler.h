@@ -0,0 +1,34 @@
+/**
+ * @file sampler.h
+ * @author James Bennion-Pedley
+ * @brief Fixed-rate A0 sampling into the audio ring
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef __FIRMWARE_SRC_SAMPLER_H__
+#define __FIRMWARE_SRC_SAMPLER_H__
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <stdint.h>
+
+/*--------------------------------- Functions --------------------------------*/
+
+// Samples only while something is listening; cheap to call every loop
+void sampler_enable(bool enable);
+
+// Stops sampling across a flash write, and starts afresh after it rather
+// than filling the time it took
+void sampler_pause(bool pause);
+
+// Reads A0 if a sample is due. Called from loop() rather than an interrupt,
+// as analogRead() isn't in IRAM and can't run while the flash is busy; call
+// it often, as each poll only takes one reading
+void sampler_poll(uint32_t t_now);
+
+/*----------------------------------------------------------------------------*/
+
+#endif /* __FIRMWARE_SRC_SAMPLER_H__ */
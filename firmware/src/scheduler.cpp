@@ -0,0 +1,102 @@
+/**
+ * @file scheduler.cpp
+ * @author James Bennion-Pedley
+ * @brief Fixed-timestep frame scheduler
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include "scheduler.h"
+
+/*---------------------------- Macros & Constants ----------------------------*/
+
+// Upper bound of each jitter bucket; the last bucket catches everything else
+static const uint32_t m_jitter_bounds[SCHEDULER_JITTER_BUCKETS] = {
+    250, 500, 1000, 2000, 5000, 10000, 20000, UINT32_MAX};
+
+/*----------------------------------- State ----------------------------------*/
+
+static uint32_t m_period_us = 0; // 0 = only render on invalidate
+static uint32_t m_next_us = 0;
+static bool m_invalid = true;
+
+static scheduler_stats_t m_stats;
+
+/*------------------------------ Private Functions ---------------------------*/
+
+static void record_jitter(uint32_t late_us)
+{
+    uint8_t i = 0;
+    while (late_us >= m_jitter_bounds[i])
+        i++;
+
+    m_stats.jitter[i]++;
+}
+
+/*------------------------------- Public Functions ---------------------------*/
+
+void scheduler_set_rate(uint8_t fps, uint32_t t_now_us)
+{
+    m_period_us = (fps == 0) ? 0 : (1000000UL / fps);
+    m_next_us = t_now_us;
+    m_invalid = true;
+}
+
+void scheduler_invalidate(void)
+{
+    m_invalid = true;
+}
+
+bool scheduler_poll(uint32_t t_now_us)
+{
+    if (m_period_us == 0)
+    {
+        if (!m_invalid)
+            return false;
+
+        m_invalid = false;
+        m_stats.frames++;
+        return true;
+    }
+
+    int32_t late_us = (int32_t)(t_now_us - m_next_us);
+
+    if (late_us < 0)
+    {
+        // Changes are shown straight away without moving the frame grid
+        if (!m_invalid)
+            return false;
+
+        m_invalid = false;
+        m_stats.frames++;
+        return true;
+    }
+
+    // Advance along the fixed grid so the rate doesn't drift; if we stalled
+    // for whole periods drop those slots rather than rendering a burst
+    uint32_t missed = (uint32_t)late_us / m_period_us;
+    m_stats.skipped += missed;
+    m_next_us += (missed + 1) * m_period_us;
+
+    record_jitter((uint32_t)late_us);
+
+    m_invalid = false;
+    m_stats.frames++;
+    return true;
+}
+
+const scheduler_stats_t *scheduler_get_stats(void)
+{
+    return &m_stats;
+}
+
+uint32_t scheduler_jitter_bound_us(uint8_t bucket)
+{
+    return m_jitter_bounds[bucket];
+}
+
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,42 @@
+/**
+ * @file scheduler.h
+ * @author James Bennion-Pedley
+ * @brief Fixed-timestep frame scheduler
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef __FIRMWARE_SRC_SCHEDULER_H__
+#define __FIRMWARE_SRC_SCHEDULER_H__
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <stdint.h>
+
+/*---------------------------- Macros & Constants ----------------------------*/
+
+#define SCHEDULER_JITTER_BUCKETS 8
+
+/*--------------------------------- Datatypes --------------------------------*/
+
+typedef struct
+{
+    uint32_t frames;                             // Frames rendered
+    uint32_t skipped;                            // Frame slots dropped to catch up
+    uint32_t jitter[SCHEDULER_JITTER_BUCKETS];   // Frame start lateness histogram
+} scheduler_stats_t;
+
+/*--------------------------------- Functions --------------------------------*/
+
+void scheduler_set_rate(uint8_t fps, uint32_t t_now_us);
+void scheduler_invalidate(void);
+bool scheduler_poll(uint32_t t_now_us);
+
+const scheduler_stats_t *scheduler_get_stats(void);
+uint32_t scheduler_jitter_bound_us(uint8_t bucket);
+
+/*----------------------------------------------------------------------------*/
+
+#endif /* __FIRMWARE_SRC_SCHEDULER_H__ */
@@ -17,6 +17,9 @@
 #include <ESP8266WebServer.h>
 #include <LittleFS.h>
 
+#include "config.h"
+#include "portal.h"
+
 /*---------------------------- Macros & Constants ----------------------------*/
 
 /*----------------------------------- State ----------------------------------*/
@@ -25,38 +28,45 @@ static ESP8266WebServer m_espServer(80); // Server for when in AP mode
 static DNSServer m_dnsServer;
 static IPAddress m_apIP(192, 168, 1, 1);
 
+// The page itself is index.html, gzipped into flash by the build (portal.h)
 // clang-format off
-static const char *m_index = "<!DOCTYPE HTML><html><body> <h1>AP Credentials</h1> <form action='/creds' method='post'> <input name='ssid' placeholder='SSID' autocapitalize='none'></input> <input name='psk' placeholder='Password' autocapitalize='none'></input> <button type='submit'>Submit</button> </form></body><style>body *{font-family: 'Courier New', Courier, monospace;}form{display: flex; flex-direction: column; gap: 1rem;}input{height: 6rem; font-size: 4rem;}button{height: 6rem; font-size: 2.5rem;}h1{text-align: center; font-size: 5rem;}</style></html>";
+static const char m_redirect[] PROGMEM = "<head><meta http-equiv=\"refresh\" content=\"0; url=http://192.168.1.1/index.html?venue-info-url=http:192.168.1.1/index.html\" /></head><body><p>redirecting...</p></body>";
 // clang-format on
 
+// Request headers the server keeps for us
+static const char *m_collect[] = {"If-None-Match"};
+
 // Hardcoded credentials - should be declared in secrets.ini
 static const char *m_ssid = WIFI_SSID;
 static const char *m_psk = WIFI_PSK;
 
-// Buffers for filesystem credentials
-static char m_ssid_buf[256];
-static char m_psk_buf[256];
-
 /*------------------------------ Private Functions ---------------------------*/
 
-static void
-handleAppleCaptivePortal(void)
+static void handleRedirect(void)
 {
-    const char *metaRefreshStr = "<head><meta http-equiv=\"refresh\" content=\"0; url=http://192.168.1.1/index.html/?venue-info-url=http:192.168.1.1/index.html\" /></head><body><p>redirecting...</p></body>";
-
+    // Captive portal checks must never be answered from a cache, or the
+    // phone decides it's online and never shows the portal
     m_espServer.sendHeader("Cache-Control", "no-cache, no-store, must-revalidate");
     m_espServer.sendHeader("Pragma", "no-cache");
     m_espServer.sendHeader("Expires", "-1");
-    m_espServer.send(200, "text/html", metaRefreshStr);
-    return;
+    m_espServer.send_P(200, "text/html", m_redirect);
 }
 
 static void handleIndex(void)
 {
-    m_espServer.sendHeader("Cache-Control", "no-cache, no-store, must-revalidate");
-    m_espServer.sendHeader("Pragma", "no-cache");
-    m_espServer.sendHeader("Expires", "-1");
-    m_espServer.send(200, "text/html", m_index);
+    // Cached, but checked every time: an unchanged page costs a 304
+    m_espServer.sendHeader("Cache-Control", "no-cache");
+    m_espServer.sendHeader("ETag", PORTAL_INDEX_ETAG);
+    if (m_espServer.header("If-None-Match") == PORTAL_INDEX_ETAG)
+    {
+        m_espServer.send(304);
+        return;
+    }
+
+    // Streamed straight from flash; every browser that can join the AP
+    // takes gzip
+    m_espServer.sendHeader("Content-Encoding", "gzip");
+    m_espServer.send_P(200, "text/html", (PGM_P)m_portal_index, sizeof(m_portal_index));
 
     // Sends SSID and creds as plaintext!
 }
@@ -76,14 +86,16 @@ static void handleCredentials()
     if (ssid.length() == 0 || psk.length() == 0)
         return;
 
-    File f1 = LittleFS.open("/ssid.txt", "w");
-    f1.print(ssid.c_str());
-    f1.flush();
-    f1.close();
-    File f2 = LittleFS.open("/psk.txt", "w");
-    f2.print(psk.c_str());
-    f1.flush();
-    f2.close();
+    // Longer than WiFi allows, so it can't be right
+    if (ssid.length() >= CONFIG_SSID_SIZE || psk.length() >= CONFIG_PSK_SIZE)
+        return;
+
+    config_t cfg = *config_get();
+    strcpy(cfg.ssid, ssid.c_str());
+    strcpy(cfg.psk, psk.c_str());
+    cfg.has_wifi_cache = false; // Belongs to the old network
+    config_set(&cfg);
+    config_flush();
 
     ESP.restart();
 }
@@ -100,27 +112,15 @@ void server_loop(void)
 const char *server_get_ssid(void)
 {
     // Return stored creds, or hardcoded defaults
-    File f = LittleFS.open("/ssid.txt", "r");
-    if (!f)
-        return m_ssid;
-
-    f.readBytes(m_ssid_buf, sizeof(m_ssid_buf));
-    f.close();
-
-    return m_ssid_buf;
+    const config_t *cfg = config_get();
+    return cfg->ssid[0] ? cfg->ssid : m_ssid;
 }
 
 const char *server_get_psk(void)
 {
     // Return stored creds, or hardcoded defaults
-    File f = LittleFS.open("/psk.txt", "r");
-    if (!f)
-        return m_psk;
-
-    f.readBytes(m_psk_buf, sizeof(m_psk_buf));
-    f.close();
-
-    return m_psk_buf;
+    const config_t *cfg = config_get();
+    return cfg->ssid[0] ? cfg->psk : m_psk;
 }
 
 void server_launch_ap(const char *ap_prefix)
@@ -140,21 +140,20 @@ void server_launch_ap(const char *ap_prefix)
     m_dnsServer.start(53, "*", m_apIP);
     m_espServer.on("/", handleIndex);
     m_espServer.on("/index.html", handleIndex);
-    m_espServer.on("/hotspot-detect.html", handleAppleCaptivePortal);
+    m_espServer.on("/hotspot-detect.html", handleRedirect);
     m_espServer.on("/creds", HTTP_POST, handleCredentials);
 
     // redirect all 404 traffic to index.html with android captive portal
-    m_espServer.onNotFound([]()
-                           {
-        const char *metaRefreshStr = "<head><meta http-equiv=\"refresh\" content=\"0; url=http://192.168.1.1/index.html?venue-info-url=http:192.168.1.1/index.html\" /></head><body><p>redirecting...</p></body>";
-        m_espServer.send(200, "text/html", metaRefreshStr); });
+    m_espServer.onNotFound(handleRedirect);
 
+    m_espServer.collectHeaders(m_collect, sizeof(m_collect) / sizeof(m_collect[0]));
     m_espServer.begin();
 }
 
 void server_initialise(void)
 {
     LittleFS.begin();
+    config_initialise();
 };
 
 /*----------------------------------------------------------------------------*/
@@ -0,0 +1,188 @@
+/**
+ * @file stream.cpp
+ * @author James Bennion-Pedley
+ * @brief Raw pixel streaming over UDP (DDP)
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <Arduino.h>
+
+#include <WiFiUdp.h>
+
+#include "leds.h"
+#include "stream.h"
+
+/*---------------------------- Macros & Constants ----------------------------*/
+
+// DDP header (multi-byte fields big-endian), optionally followed by a timecode:
+//   [0] flags  [1] sequence (low 4 bits)  [2] data type  [3] destination id
+//   [4..7] data offset, bytes  [8..9] data length, bytes
+#define DDP_HEADER_SIZE 10
+#define DDP_TIMECODE_SIZE 4
+
+#define DDP_FLAG_VERSION_MASK 0xC0
+#define DDP_FLAG_VERSION_1 0x40
+#define DDP_FLAG_TIMECODE 0x10
+#define DDP_FLAG_STORAGE 0x08
+#define DDP_FLAG_REPLY 0x04
+#define DDP_FLAG_QUERY 0x02
+#define DDP_FLAG_PUSH 0x01 // Last packet of a frame
+
+#define DDP_ID_DISPLAY 1
+#define DDP_ID_ALL 255
+
+// Bounded so a flood of packets can't starve MQTT or rendering
+#define STREAM_PACKETS_PER_LOOP 8
+
+// After this long without packets, accept any sequence number again
+#define STREAM_RESYNC_MS 1000
+
+/*----------------------------------- State ----------------------------------*/
+
+static WiFiUDP m_udp;
+static bool m_enabled = false;
+
+static uint8_t m_seq = 0; // Last accepted sequence number, 0 = none yet
+static uint32_t m_t_last = 0;
+
+static stream_stats_t m_stats;
+
+/*------------------------------ Private Functions ---------------------------*/
+
+// DDP sequence numbers run 1-15 and 0 means the sender doesn't use them.
+// Anything not up to 7 ahead of the last one is a duplicate or arrived late
+static bool sequence_ok(uint8_t seq, uint32_t t_now)
+{
+    if ((t_now - m_t_last) > STREAM_RESYNC_MS)
+        m_seq = 0;
+    m_t_last = t_now;
+
+    if (seq == 0)
+        return true;
+
+    if (m_seq != 0)
+    {
+        uint8_t ahead = (seq - m_seq) & 0x0F;
+        if (ahead == 0 || ahead > 7)
+            return false;
+    }
+
+    m_seq = seq;
+    return true;
+}
+
+// Returns true if the packet completed a frame
+static bool read_packet(int size, uint32_t t_now)
+{
+    uint8_t header[DDP_HEADER_SIZE + DDP_TIMECODE_SIZE];
+    if (size < DDP_HEADER_SIZE || m_udp.read(header, DDP_HEADER_SIZE) != DDP_HEADER_SIZE)
+    {
+        m_stats.invalid++;
+        return false;
+    }
+
+    // Only pixel data is handled: queries, replies and storage aren't
+    uint8_t flags = header[0];
+    if ((flags & DDP_FLAG_VERSION_MASK) != DDP_FLAG_VERSION_1 ||
+        (flags & (DDP_FLAG_STORAGE | DDP_FLAG_REPLY | DDP_FLAG_QUERY)) ||
+        (header[3] != DDP_ID_DISPLAY && header[3] != DDP_ID_ALL))
+    {
+        m_stats.invalid++;
+        return false;
+    }
+
+    if (!sequence_ok(header[1] & 0x0F, t_now))
+    {
+        m_stats.late++;
+        return false;
+    }
+
+    size -= DDP_HEADER_SIZE;
+    if (flags & DDP_FLAG_TIMECODE)
+    {
+        if (m_udp.read(&header[DDP_HEADER_SIZE], DDP_TIMECODE_SIZE) != DDP_TIMECODE_SIZE)
+        {
+            m_stats.invalid++;
+            return false;
+        }
+        size -= DDP_TIMECODE_SIZE;
+    }
+
+    uint32_t offset = ((uint32_t)header[4] << 24) | ((uint32_t)header[5] << 16) | (header[6] << 8) | header[7];
+    uint32_t length = (header[8] << 8) | header[9];
+    if (length > (uint32_t)size)
+        length = size;
+
+    // Pixel data goes directly from the socket into the back buffer;
+    // anything past the configured strips is left unread
+    uint16_t capacity;
+    uint8_t *back = leds_stream_buffer(&capacity);
+    if (offset < capacity)
+    {
+        if (length > capacity - offset)
+            length = capacity - offset;
+        m_udp.read(&back[offset], length);
+    }
+
+    if (!(flags & DDP_FLAG_PUSH))
+        return false;
+
+    leds_stream_commit();
+    m_stats.frames++;
+    return true;
+}
+
+/*------------------------------- Public Functions ---------------------------*/
+
+void stream_enable(bool enable)
+{
+    if (enable == m_enabled)
+        return;
+    m_enabled = enable;
+
+    if (enable)
+    {
+        m_udp.begin(STREAM_PORT);
+    }
+    else
+    {
+        // Closing frees whatever was still queued; a frame that was complete
+        // but never shown mustn't come back when Stream does
+        m_udp.stop();
+        leds_stream_discard();
+        m_seq = 0;
+    }
+}
+
+bool stream_loop(uint32_t t_now)
+{
+    if (!m_enabled)
+        return false;
+
+    for (uint8_t i = 0; i < STREAM_PACKETS_PER_LOOP; i++)
+    {
+        int size = m_udp.parsePacket();
+        if (size <= 0)
+            break;
+
+        // Stop at a complete frame, so the next one can't overwrite it
+        // before it has been swapped in
+        m_stats.packets++;
+        if (read_packet(size, t_now))
+            return true;
+    }
+
+    return false;
+}
+
+const stream_stats_t *stream_get_stats(void)
+{
+    return &m_stats;
+}
+
+/*----------------------------------------------------------------------------*/
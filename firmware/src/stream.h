@@ -0,0 +1,45 @@
+/**
+ * @file stream.h
+ * @author James Bennion-Pedley
+ * @brief Raw pixel streaming over UDP (DDP)
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef __FIRMWARE_SRC_STREAM_H__
+#define __FIRMWARE_SRC_STREAM_H__
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <stdint.h>
+
+/*---------------------------- Macros & Constants ----------------------------*/
+
+#define STREAM_PORT 4048 // Standard DDP port
+
+/*--------------------------------- Datatypes --------------------------------*/
+
+typedef struct
+{
+    uint32_t packets; // Datagrams received
+    uint32_t frames;  // Complete frames handed to the Stream pattern
+    uint32_t late;    // Packets dropped for arriving out of order
+    uint32_t invalid; // Packets that weren't DDP pixel data for us
+} stream_stats_t;
+
+/*--------------------------------- Functions --------------------------------*/
+
+// Opens the socket only while something is showing frames, so packets
+// can't queue up in lwIP otherwise; cheap to call every loop
+void stream_enable(bool enable);
+
+// Reads waiting packets; returns true once a complete frame is ready to show
+bool stream_loop(uint32_t t_now);
+
+const stream_stats_t *stream_get_stats(void);
+
+/*----------------------------------------------------------------------------*/
+
+#endif /* __FIRMWARE_SRC_STREAM_H__ */
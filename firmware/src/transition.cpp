@@ -0,0 +1,123 @@
+/**
+ * @file transition.cpp
+ * @author James Bennion-Pedley
+ * @brief Crossfades between patterns and colours
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <string.h>
+
+#include "transition.h"
+
+/*--------------------------------- Datatypes --------------------------------*/
+
+// Everything that decides what a pattern draws, besides time
+typedef struct
+{
+    pattern_id_t id;
+    uint8_t cols[3];
+    uint32_t seed;
+} transition_look_t;
+
+/*----------------------------------- State ----------------------------------*/
+
+static uint16_t m_duration = TRANSITION_DEFAULT_MS;
+
+static bool m_started = false; // Has anything been drawn yet?
+static transition_look_t m_current;
+static transition_look_t m_outgoing;
+
+static bool m_active = false;
+static bool m_outgoing_live = false; // Keep animating it, or hold its last frame
+static uint32_t m_t_start = 0;
+
+/*------------------------------ Private Functions ---------------------------*/
+
+static bool same_look(const transition_look_t *a, const transition_look_t *b)
+{
+    return a->id == b->id && a->seed == b->seed && !memcmp(a->cols, b->cols, sizeof(a->cols));
+}
+
+static void begin(const transition_look_t *next, uint32_t t_now)
+{
+    // Streamed frames come with their own timing, so always cut to and from them
+    bool cut = !m_started || m_duration == 0 ||
+               next->id == PATTERN_STREAM || m_current.id == PATTERN_STREAM;
+
+    patterns_start(next->id);
+
+    if (cut)
+    {
+        m_active = false;
+        leds_layers_select(LEDS_LAYER_FRONT);
+    }
+    else
+    {
+        // Changing again mid-fade holds the current blend and fades from
+        // that. So does a new colour or seed for the same pattern, which
+        // would otherwise share its state with its own replacement
+        m_outgoing_live = !m_active && next->id != m_current.id;
+        m_outgoing = m_current;
+        m_active = true;
+        m_t_start = t_now;
+        leds_layers_begin();
+    }
+
+    m_current = *next;
+    m_started = true;
+}
+
+/*------------------------------- Public Functions ---------------------------*/
+
+void transition_set_duration(uint16_t ms)
+{
+    m_duration = ms;
+}
+
+void transition_render(pattern_id_t id, const leds_frame_t *frame, uint32_t t_now)
+{
+    transition_look_t next;
+    next.id = id;
+    memcpy(next.cols, frame->cols, sizeof(next.cols));
+    next.seed = frame->seed;
+
+    if (!m_started || !same_look(&next, &m_current))
+        begin(&next, t_now);
+
+    uint32_t elapsed = t_now - m_t_start;
+    if (m_active && elapsed >= m_duration)
+    {
+        leds_layers_end();
+        m_active = false;
+    }
+
+    if (!m_active)
+    {
+        patterns_render(id, frame);
+        return;
+    }
+
+    if (m_outgoing_live)
+    {
+        leds_frame_t outgoing = {frame->t, m_outgoing.seed, m_outgoing.cols};
+        leds_layers_select(LEDS_LAYER_OUTGOING);
+        patterns_render(m_outgoing.id, &outgoing);
+    }
+
+    leds_layers_select(LEDS_LAYER_INCOMING);
+    patterns_render(id, frame);
+
+    leds_layers_blend((elapsed * 255) / m_duration);
+}
+
+bool transition_active(void)
+{
+    return m_active;
+}
+
+/*----------------------------------------------------------------------------*/
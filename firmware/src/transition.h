@@ -0,0 +1,38 @@
+/**
+ * @file transition.h
+ * @author James Bennion-Pedley
+ * @brief Crossfades between patterns and colours
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef __FIRMWARE_SRC_TRANSITION_H__
+#define __FIRMWARE_SRC_TRANSITION_H__
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <stdint.h>
+
+#include "leds.h"
+#include "patterns.h"
+
+/*---------------------------- Macros & Constants ----------------------------*/
+
+#define TRANSITION_DEFAULT_MS 500
+#define TRANSITION_FPS 50 // Minimum frame rate while fading
+
+/*--------------------------------- Functions --------------------------------*/
+
+// 0 makes every change an instant cut
+void transition_set_duration(uint16_t ms);
+
+// Renders pattern 'id' with the frame's colour and seed. When any of them
+// differ from the last frame, fades across from what was showing
+void transition_render(pattern_id_t id, const leds_frame_t *frame, uint32_t t_now);
+bool transition_active(void);
+
+/*----------------------------------------------------------------------------*/
+
+#endif /* __FIRMWARE_SRC_TRANSITION_H__ */
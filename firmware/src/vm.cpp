@@ -0,0 +1,469 @@
+/**
+ * @file vm.cpp
+ * @author James Bennion-Pedley
+ * @brief Bytecode interpreter for user-defined patterns
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <string.h>
+
+#include <FastLED.h>
+
+#include "vm.h"
+
+/*--------------------------------- Datatypes --------------------------------*/
+
+// What the inputs read while running one pass
+typedef struct
+{
+    const vm_program_t *prog;
+    const leds_frame_t *frame;
+    int32_t locals[VM_LOCALS];
+    int32_t index;
+    int32_t length;
+    int32_t prev;
+} vm_context_t;
+
+/*----------------------------------- State ----------------------------------*/
+
+static const uint8_t m_pops[VM_OP_COUNT] = {
+#define VM_OP_POPS(op, pops, pushes, imm) pops,
+    VM_OP_LIST(VM_OP_POPS)
+#undef VM_OP_POPS
+};
+
+static const uint8_t m_pushes[VM_OP_COUNT] = {
+#define VM_OP_PUSHES(op, pops, pushes, imm) pushes,
+    VM_OP_LIST(VM_OP_PUSHES)
+#undef VM_OP_PUSHES
+};
+
+static const uint8_t m_imm[VM_OP_COUNT] = {
+#define VM_OP_IMM(op, pops, pushes, imm) imm,
+    VM_OP_LIST(VM_OP_IMM)
+#undef VM_OP_IMM
+};
+
+// Verifier scratch: stack depth on the way into each instruction (-1 until
+// something reaches it), and which offsets start an instruction
+static int8_t m_depth[VM_MAX_CODE + 1];
+static bool m_boundary[VM_MAX_CODE + 1];
+
+static vm_program_t m_program;
+static bool m_loaded = false;
+static vm_stats_t m_stats;
+
+/*------------------------------ Private Functions ---------------------------*/
+
+static inline int32_t pack(uint8_t r, uint8_t g, uint8_t b)
+{
+    return ((int32_t)r << 16) | ((int32_t)g << 8) | b;
+}
+
+static bool merge_depth(uint16_t target, int8_t depth)
+{
+    if (m_depth[target] < 0)
+        m_depth[target] = depth;
+    return m_depth[target] == depth;
+}
+
+// Jumps only go forwards, so one pass in order has seen every way into an
+// instruction by the time it gets there
+static vm_result_t verify_segment(const uint8_t *code, uint16_t length, int8_t final_depth)
+{
+    memset(m_depth, -1, sizeof(m_depth));
+    memset(m_boundary, 0, sizeof(m_boundary));
+    m_depth[0] = 0;
+
+    uint16_t pc = 0;
+    while (pc < length)
+    {
+        uint8_t op = code[pc];
+        if (op >= VM_OP_COUNT)
+            return VM_ERR_OPCODE;
+
+        uint16_t next = pc + 1 + m_imm[op];
+        if (next > length)
+            return VM_ERR_TRUNCATED;
+        m_boundary[pc] = true;
+
+        if ((op == VM_OP_LOAD || op == VM_OP_STORE) && code[pc + 1] >= VM_LOCALS)
+            return VM_ERR_LOCAL;
+
+        uint16_t target = next;
+        if (op == VM_OP_JZ || op == VM_OP_JMP)
+        {
+            target = next + code[pc + 1];
+            if (target > length)
+                return VM_ERR_JUMP;
+        }
+
+        // Code nothing jumps or falls into is checked, but never runs
+        int8_t depth = m_depth[pc];
+        if (depth >= 0)
+        {
+            if (depth < m_pops[op])
+                return VM_ERR_STACK;
+            depth = depth - m_pops[op] + m_pushes[op];
+            if (depth > VM_STACK_SIZE)
+                return VM_ERR_STACK;
+
+            if (op != VM_OP_JMP && !merge_depth(next, depth))
+                return VM_ERR_STACK;
+            if ((op == VM_OP_JZ || op == VM_OP_JMP) && !merge_depth(target, depth))
+                return VM_ERR_STACK;
+        }
+
+        pc = next;
+    }
+
+    // Every jump has to land on an instruction, or the end
+    m_boundary[length] = true;
+    for (uint16_t i = 0; i <= length; i++)
+    {
+        if (m_depth[i] >= 0 && !m_boundary[i])
+            return VM_ERR_JUMP;
+    }
+
+    return (m_depth[length] == final_depth) ? VM_OK : VM_ERR_STACK;
+}
+
+static int32_t palette_lookup(const vm_program_t *prog, int32_t x)
+{
+    if (prog->palette_count == 0)
+        return 0;
+
+    // Entries are spread evenly round the 0-255 circle, blended between
+    uint16_t pos = (x & 0xFF) * prog->palette_count;
+    uint8_t i = pos >> 8, frac = pos & 0xFF;
+    const uint8_t *a = prog->palette[i];
+    const uint8_t *b = prog->palette[(i + 1) % prog->palette_count];
+    return pack(blend8(a[0], b[0], frac), blend8(a[1], b[1], frac), blend8(a[2], b[2], frac));
+}
+
+// Runs one verified pass and returns what it left on top of the stack
+static int32_t execute(const uint8_t *code, uint16_t length, vm_context_t *ctx, uint32_t *ops)
+{
+    int32_t stack[VM_STACK_SIZE];
+    int32_t *sp = stack;
+    uint16_t pc = 0;
+
+#define PUSH(v) (*sp++ = (v))
+#define POP() (*--sp)
+
+    while (pc < length)
+    {
+        uint8_t op = code[pc++];
+        (*ops)++;
+
+        int32_t a, b, c;
+        switch (op)
+        {
+        case VM_OP_PUSH8:
+            PUSH(code[pc++]);
+            break;
+        case VM_OP_PUSH16:
+            PUSH((int16_t)(code[pc] | (code[pc + 1] << 8)));
+            pc += 2;
+            break;
+        case VM_OP_PUSH32:
+            PUSH((int32_t)(code[pc] | (code[pc + 1] << 8) | (code[pc + 2] << 16) | ((uint32_t)code[pc + 3] << 24)));
+            pc += 4;
+            break;
+        case VM_OP_LOAD:
+            PUSH(ctx->locals[code[pc++]]);
+            break;
+        case VM_OP_STORE:
+            ctx->locals[code[pc++]] = POP();
+            break;
+        case VM_OP_INDEX:
+            PUSH(ctx->index);
+            break;
+        case VM_OP_LENGTH:
+            PUSH(ctx->length);
+            break;
+        case VM_OP_TIME:
+            PUSH((int32_t)ctx->frame->t);
+            break;
+        case VM_OP_SEED:
+            PUSH((int32_t)ctx->frame->seed);
+            break;
+        case VM_OP_COLOUR:
+        {
+            const uint8_t *cols = ctx->frame->cols;
+            PUSH(cols ? pack(cols[0], cols[1], cols[2]) : 0);
+            break;
+        }
+        case VM_OP_PREV:
+            PUSH(ctx->prev);
+            break;
+
+        // Arithmetic wraps rather than being undefined
+        case VM_OP_ADD:
+            b = POP(), a = POP();
+            PUSH((int32_t)((uint32_t)a + (uint32_t)b));
+            break;
+        case VM_OP_SUB:
+            b = POP(), a = POP();
+            PUSH((int32_t)((uint32_t)a - (uint32_t)b));
+            break;
+        case VM_OP_MUL:
+            b = POP(), a = POP();
+            PUSH((int32_t)((uint32_t)a * (uint32_t)b));
+            break;
+        case VM_OP_DIV:
+            b = POP(), a = POP();
+            PUSH((b == 0) ? 0 : (b == -1) ? (int32_t)(0 - (uint32_t)a) : a / b);
+            break;
+        case VM_OP_MOD:
+            b = POP(), a = POP();
+            PUSH((b == 0 || b == -1) ? 0 : a % b);
+            break;
+        case VM_OP_AND:
+            b = POP(), a = POP();
+            PUSH(a & b);
+            break;
+        case VM_OP_OR:
+            b = POP(), a = POP();
+            PUSH(a | b);
+            break;
+        case VM_OP_XOR:
+            b = POP(), a = POP();
+            PUSH(a ^ b);
+            break;
+        case VM_OP_SHL:
+            b = POP(), a = POP();
+            PUSH((int32_t)((uint32_t)a << (b & 31)));
+            break;
+        case VM_OP_SHR:
+            b = POP(), a = POP();
+            PUSH((int32_t)((uint32_t)a >> (b & 31)));
+            break;
+        case VM_OP_MIN:
+            b = POP(), a = POP();
+            PUSH(a < b ? a : b);
+            break;
+        case VM_OP_MAX:
+            b = POP(), a = POP();
+            PUSH(a > b ? a : b);
+            break;
+        case VM_OP_LT:
+            b = POP(), a = POP();
+            PUSH(a < b);
+            break;
+        case VM_OP_EQ:
+            b = POP(), a = POP();
+            PUSH(a == b);
+            break;
+        case VM_OP_NEG:
+            a = POP();
+            PUSH((int32_t)(0 - (uint32_t)a));
+            break;
+        case VM_OP_NOT:
+            a = POP();
+            PUSH(!a);
+            break;
+        case VM_OP_DUP:
+            a = POP();
+            PUSH(a);
+            PUSH(a);
+            break;
+        case VM_OP_DROP:
+            sp--;
+            break;
+        case VM_OP_SWAP:
+            b = POP(), a = POP();
+            PUSH(b);
+            PUSH(a);
+            break;
+
+        // FastLED's wave functions, which read the frame's time
+        case VM_OP_SIN8:
+            a = POP();
+            PUSH(sin8(a));
+            break;
+        case VM_OP_SIN16:
+            a = POP();
+            PUSH(sin16(a));
+            break;
+        case VM_OP_BEAT8:
+            a = POP();
+            PUSH(beat8(a));
+            break;
+        case VM_OP_BEATSIN8:
+            c = POP(), b = POP(), a = POP();
+            PUSH(beatsin8(a, b, c));
+            break;
+        case VM_OP_BEATSIN88:
+            c = POP(), b = POP(), a = POP();
+            PUSH(beatsin88(a, b, c));
+            break;
+        case VM_OP_SCALE8:
+            b = POP(), a = POP();
+            PUSH(scale8(a, b));
+            break;
+        case VM_OP_QADD8:
+            b = POP(), a = POP();
+            PUSH(qadd8(a, b));
+            break;
+        case VM_OP_QSUB8:
+            b = POP(), a = POP();
+            PUSH(qsub8(a, b));
+            break;
+
+        // Colours are 0xRRGGBB
+        case VM_OP_HSV:
+        {
+            c = POP(), b = POP(), a = POP();
+            CRGB rgb = CHSV(a, b, c);
+            PUSH(pack(rgb.r, rgb.g, rgb.b));
+            break;
+        }
+        case VM_OP_RGB:
+            c = POP(), b = POP(), a = POP();
+            PUSH(pack(a, b, c));
+            break;
+        case VM_OP_PALETTE:
+            a = POP();
+            PUSH(palette_lookup(ctx->prog, a));
+            break;
+        case VM_OP_BLEND:
+            c = POP(), b = POP(), a = POP();
+            PUSH(pack(blend8(a >> 16, b >> 16, c), blend8(a >> 8, b >> 8, c), blend8(a, b, c)));
+            break;
+
+        case VM_OP_JZ:
+            a = POP();
+            pc += a ? 1 : 1 + code[pc];
+            break;
+        case VM_OP_JMP:
+            pc += 1 + code[pc];
+            break;
+        }
+    }
+
+#undef PUSH
+#undef POP
+
+    return (sp > stack) ? sp[-1] : 0;
+}
+
+/*------------------------------- Public Functions ---------------------------*/
+
+vm_result_t vm_verify(const uint8_t *image, unsigned int length, vm_program_t *prog)
+{
+    if (length < VM_HEADER_SIZE || image[0] != 'V' || image[1] != 'M' || image[2] != VM_VERSION)
+        return VM_ERR_HEADER;
+
+    uint8_t palette_count = image[3];
+    uint16_t prologue_length = image[4] | (image[5] << 8);
+    uint16_t body_length = image[6] | (image[7] << 8);
+    if (palette_count > VM_PALETTE_SIZE || prologue_length + body_length > VM_MAX_CODE ||
+        length != VM_HEADER_SIZE + palette_count * 3u + prologue_length + body_length)
+        return VM_ERR_HEADER;
+
+    const uint8_t *code = &image[VM_HEADER_SIZE + palette_count * 3];
+
+    // The prologue leaves nothing behind; the body leaves one colour
+    vm_result_t result = verify_segment(code, prologue_length, 0);
+    if (result == VM_OK)
+        result = verify_segment(&code[prologue_length], body_length, 1);
+    if (result != VM_OK)
+        return result;
+
+    memset(prog, 0, sizeof(*prog));
+    prog->palette_count = palette_count;
+    memcpy(prog->palette, &image[VM_HEADER_SIZE], palette_count * 3);
+    prog->prologue_length = prologue_length;
+    prog->body_length = body_length;
+    memcpy(prog->code, code, prologue_length + body_length);
+
+    return VM_OK;
+}
+
+const char *vm_result_str(vm_result_t result)
+{
+    switch (result)
+    {
+    case VM_OK:
+        return "ok";
+    case VM_ERR_HEADER:
+        return "bad header";
+    case VM_ERR_OPCODE:
+        return "unknown opcode";
+    case VM_ERR_TRUNCATED:
+        return "truncated instruction";
+    case VM_ERR_JUMP:
+        return "bad jump";
+    case VM_ERR_STACK:
+        return "stack depth";
+    case VM_ERR_LOCAL:
+        return "bad local";
+    }
+    return "unknown";
+}
+
+uint32_t vm_run(const vm_program_t *prog, const leds_frame_t *frame, uint8_t *pixels, uint16_t n, uint32_t budget,
+                bool *truncated)
+{
+    vm_context_t ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.prog = prog;
+    ctx.frame = frame;
+    ctx.length = n;
+
+    uint32_t ops = 0;
+    execute(prog->code, prog->prologue_length, &ctx, &ops);
+
+    // A pass can't run longer than the body, so stop before one could overrun
+    const uint8_t *body = &prog->code[prog->prologue_length];
+    uint16_t i = 0;
+    for (; i < n && ops + prog->body_length <= budget; i++)
+    {
+        uint8_t *px = &pixels[i * 3];
+        ctx.index = i;
+        ctx.prev = pack(px[0], px[1], px[2]);
+
+        int32_t colour = execute(body, prog->body_length, &ctx, &ops);
+        px[0] = colour >> 16;
+        px[1] = colour >> 8;
+        px[2] = colour;
+    }
+
+    *truncated = i < n;
+    return ops;
+}
+
+void vm_install(const vm_program_t *prog)
+{
+    m_loaded = prog != nullptr;
+    if (m_loaded)
+        m_program = *prog;
+}
+
+void vm_render(const leds_frame_t *frame, uint8_t *pixels, uint16_t n)
+{
+    if (!m_loaded)
+    {
+        memset(pixels, 0, n * 3);
+        return;
+    }
+
+    bool truncated;
+    m_stats.ops = vm_run(&m_program, frame, pixels, n, VM_FRAME_BUDGET, &truncated);
+    m_stats.frames++;
+    if (truncated)
+        m_stats.overruns++;
+}
+
+const vm_stats_t *vm_get_stats(void)
+{
+    return &m_stats;
+}
+
+/*----------------------------------------------------------------------------*/
@@ -0,0 +1,148 @@
+/**
+ * @file vm.h
+ * @author James Bennion-Pedley
+ * @brief Bytecode interpreter for user-defined patterns
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef __FIRMWARE_SRC_VM_H__
+#define __FIRMWARE_SRC_VM_H__
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <stdint.h>
+
+#include "leds.h"
+
+/*---------------------------- Macros & Constants ----------------------------*/
+
+// Program image, version 1 (multi-byte fields little-endian):
+//   [0] 'V'  [1] 'M'  [2] version  [3] palette entries (0-16)
+//   [4..5] prologue length  [6..7] body length
+//   then palette RGB triples, prologue code, body code
+// The prologue runs once per frame, then the body once per pixel, leaving
+// the pixel's colour (0xRRGGBB) as the only value on the stack. Locals are
+// zeroed each frame and keep their values from one pixel to the next.
+// Jumps only go forwards, so each pass is bounded by its length
+#define VM_VERSION 1
+#define VM_HEADER_SIZE 8
+#define VM_MAX_CODE 512
+#define VM_MAX_IMAGE (VM_HEADER_SIZE + 16 * 3 + VM_MAX_CODE)
+#define VM_PALETTE_SIZE 16
+#define VM_STACK_SIZE 16
+#define VM_LOCALS 16
+
+// Instructions per frame; pixels past it keep their last colour. At some
+// 40 cycles an instruction an ESP8266 runs about 2 a microsecond, so this is
+// around 10 ms: half a frame at 50 fps, leaving the rest for show() and the
+// network. `program vm` reports the rate on the host to scale from
+#define VM_FRAME_BUDGET 20000
+
+// Opcodes: name, values popped, values pushed, immediate bytes. These are
+// in uploaded programs, so new ones go on the end
+#define VM_OP_LIST(X)          \
+    X(VM_OP_PUSH8, 0, 1, 1)    \
+    X(VM_OP_PUSH16, 0, 1, 2)   \
+    X(VM_OP_PUSH32, 0, 1, 4)   \
+    X(VM_OP_LOAD, 0, 1, 1)     \
+    X(VM_OP_STORE, 1, 0, 1)    \
+    X(VM_OP_INDEX, 0, 1, 0)    \
+    X(VM_OP_LENGTH, 0, 1, 0)   \
+    X(VM_OP_TIME, 0, 1, 0)     \
+    X(VM_OP_SEED, 0, 1, 0)     \
+    X(VM_OP_COLOUR, 0, 1, 0)   \
+    X(VM_OP_PREV, 0, 1, 0)     \
+    X(VM_OP_ADD, 2, 1, 0)      \
+    X(VM_OP_SUB, 2, 1, 0)      \
+    X(VM_OP_MUL, 2, 1, 0)      \
+    X(VM_OP_DIV, 2, 1, 0)      \
+    X(VM_OP_MOD, 2, 1, 0)      \
+    X(VM_OP_AND, 2, 1, 0)      \
+    X(VM_OP_OR, 2, 1, 0)       \
+    X(VM_OP_XOR, 2, 1, 0)      \
+    X(VM_OP_SHL, 2, 1, 0)      \
+    X(VM_OP_SHR, 2, 1, 0)      \
+    X(VM_OP_MIN, 2, 1, 0)      \
+    X(VM_OP_MAX, 2, 1, 0)      \
+    X(VM_OP_LT, 2, 1, 0)       \
+    X(VM_OP_EQ, 2, 1, 0)       \
+    X(VM_OP_NEG, 1, 1, 0)      \
+    X(VM_OP_NOT, 1, 1, 0)      \
+    X(VM_OP_DUP, 1, 2, 0)      \
+    X(VM_OP_DROP, 1, 0, 0)     \
+    X(VM_OP_SWAP, 2, 2, 0)     \
+    X(VM_OP_SIN8, 1, 1, 0)     \
+    X(VM_OP_SIN16, 1, 1, 0)    \
+    X(VM_OP_BEAT8, 1, 1, 0)    \
+    X(VM_OP_BEATSIN8, 3, 1, 0) \
+    X(VM_OP_BEATSIN88, 3, 1, 0) \
+    X(VM_OP_SCALE8, 2, 1, 0)   \
+    X(VM_OP_QADD8, 2, 1, 0)    \
+    X(VM_OP_QSUB8, 2, 1, 0)    \
+    X(VM_OP_HSV, 3, 1, 0)      \
+    X(VM_OP_RGB, 3, 1, 0)      \
+    X(VM_OP_PALETTE, 1, 1, 0)  \
+    X(VM_OP_BLEND, 3, 1, 0)    \
+    X(VM_OP_JZ, 1, 0, 1)       \
+    X(VM_OP_JMP, 0, 0, 1)
+
+/*--------------------------------- Datatypes --------------------------------*/
+
+typedef enum
+{
+#define VM_OP_ENUM(op, pops, pushes, imm) op,
+    VM_OP_LIST(VM_OP_ENUM)
+#undef VM_OP_ENUM
+    VM_OP_COUNT,
+} vm_op_t;
+
+typedef enum
+{
+    VM_OK,
+    VM_ERR_HEADER,    // Bad magic, version or lengths
+    VM_ERR_OPCODE,    // Unknown instruction
+    VM_ERR_TRUNCATED, // Immediate runs off the end
+    VM_ERR_JUMP,      // Backwards, or into the middle of an instruction
+    VM_ERR_STACK,     // Underflow, overflow, or paths disagree on depth
+    VM_ERR_LOCAL,     // Local index out of range
+} vm_result_t;
+
+// A verified program, ready to run
+typedef struct
+{
+    uint8_t palette_count;
+    uint8_t palette[VM_PALETTE_SIZE][3];
+    uint16_t prologue_length;
+    uint16_t body_length;
+    uint8_t code[VM_MAX_CODE]; // Prologue, then body
+} vm_program_t;
+
+typedef struct
+{
+    uint32_t frames;   // Frames run
+    uint32_t overruns; // Frames cut short by the budget
+    uint32_t ops;      // Instructions in the last frame
+} vm_stats_t;
+
+/*--------------------------------- Functions --------------------------------*/
+
+// Checks everything the interpreter relies on, so it can run unchecked
+vm_result_t vm_verify(const uint8_t *image, unsigned int length, vm_program_t *prog);
+const char *vm_result_str(vm_result_t result);
+
+// Renders n RGB pixels in place; returns instructions executed, and sets
+// truncated if the budget stopped it before the last pixel
+uint32_t vm_run(const vm_program_t *prog, const leds_frame_t *frame, uint8_t *pixels, uint16_t n, uint32_t budget,
+                bool *truncated);
+
+// The program behind the Custom pattern (nullptr for none, which draws black)
+void vm_install(const vm_program_t *prog);
+void vm_render(const leds_frame_t *frame, uint8_t *pixels, uint16_t n);
+const vm_stats_t *vm_get_stats(void);
+
+/*----------------------------------------------------------------------------*/
+
+#endif /* __FIRMWARE_SRC_VM_H__ */
@@ -0,0 +1,82 @@
+/**
+ * @file waves.cpp
+ * @author James Bennion-Pedley
+ * @brief Closed-form integrals of FastLED beat waves
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <math.h>
+
+#include <FastLED.h>
+
+#include "waves.h"
+
+/*---------------------------- Macros & Constants ----------------------------*/
+
+// beat88() advances (bpm88 * 280) / 2^32 turns per ms
+#define WAVES_RATE(bpm88) ((uint32_t)(bpm88) * 280)
+
+#define WAVES_TURN_MS(k) (4294967296.0f / (2.0f * (float)M_PI * (float)(k)))
+
+/*------------------------------ Private Functions ---------------------------*/
+
+// Phases are reduced in 32-bit fixed point, exactly as beat88() does, so the
+// float maths only ever sees one turn's worth of angle
+
+// Integral over [0, t] of sin(wt)
+static float sin_integral(uint32_t t, uint32_t k)
+{
+    uint16_t theta = (t * k) >> 16;
+    return (1.0f - cos16(theta) / 32768.0f) * WAVES_TURN_MS(k);
+}
+
+// Integral over [0, t] of cos(wt)
+static float cos_integral(uint32_t t, uint32_t k)
+{
+    if (k == 0)
+        return (float)t;
+
+    uint16_t theta = (t * k) >> 16;
+    return (sin16(theta) / 32768.0f) * WAVES_TURN_MS(k);
+}
+
+/*------------------------------- Public Functions ---------------------------*/
+
+uint16_t waves_integral(uint32_t t, const waves_beatsin_t *a, uint16_t div)
+{
+    // a(t) = m + r sin(wt), with m and r held doubled to stay integers
+    uint32_t m2 = a->lo + a->hi;
+    float r = (a->hi - a->lo) / 2.0f;
+
+    uint16_t linear = ((uint64_t)m2 * t) / (2 * div);
+    float wave = r * sin_integral(t, WAVES_RATE(a->bpm88)) / div;
+
+    return linear + (int32_t)lroundf(wave);
+}
+
+uint16_t waves_product_integral(uint32_t t, const waves_beatsin_t *a, const waves_beatsin_t *b, uint16_t div)
+{
+    uint32_t ka = WAVES_RATE(a->bpm88);
+    uint32_t kb = WAVES_RATE(b->bpm88);
+    uint32_t ma2 = a->lo + a->hi;
+    uint32_t mb2 = b->lo + b->hi;
+    float ra = (a->hi - a->lo) / 2.0f;
+    float rb = (b->hi - b->lo) / 2.0f;
+
+    // (ma + ra sin)(mb + rb sin) = ma mb + ma rb sin + mb ra sin + ra rb sin sin,
+    // and sin(x) sin(y) = (cos(x - y) - cos(x + y)) / 2
+    uint16_t linear = ((uint64_t)ma2 * mb2 * t) / (4 * (uint32_t)div);
+
+    float wave = (ma2 / 2.0f) * rb * sin_integral(t, kb);
+    wave += (mb2 / 2.0f) * ra * sin_integral(t, ka);
+    wave += (ra * rb / 2.0f) * (cos_integral(t, (ka > kb) ? ka - kb : kb - ka) - cos_integral(t, ka + kb));
+
+    return linear + (int32_t)lroundf(wave / div);
+}
+
+/*----------------------------------------------------------------------------*/
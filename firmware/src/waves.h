@@ -0,0 +1,42 @@
+/**
+ * @file waves.h
+ * @author James Bennion-Pedley
+ * @brief Closed-form integrals of FastLED beat waves
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef __FIRMWARE_SRC_WAVES_H__
+#define __FIRMWARE_SRC_WAVES_H__
+
+/*--------------------------------- Includes ---------------------------------*/
+
+#include <stdint.h>
+
+/*--------------------------------- Datatypes --------------------------------*/
+
+// Arguments of a beatsin88() call; beatsin16(bpm, ...) is bpm88 = bpm << 8
+typedef struct
+{
+    uint16_t bpm88;
+    uint16_t lo;
+    uint16_t hi;
+} waves_beatsin_t;
+
+/*--------------------------------- Functions --------------------------------*/
+
+// Patterns that accumulate "delta ms * beatsin" each frame depend on when they
+// started. These give the same running totals as a function of time alone,
+// wrapped to 16 bits, so every light computes the same value for the same t
+
+// Integral over [0, t] ms of a / div
+uint16_t waves_integral(uint32_t t, const waves_beatsin_t *a, uint16_t div);
+
+// Integral over [0, t] ms of a * b / div
+uint16_t waves_product_integral(uint32_t t, const waves_beatsin_t *a, const waves_beatsin_t *b, uint16_t div);
+
+/*----------------------------------------------------------------------------*/
+
+#endif /* __FIRMWARE_SRC_WAVES_H__ */
@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+"""
+@file ddp_send.py
+@author James Bennion-Pedley
+@brief Stream pixels to a light in Stream mode over DDP
+@date 17/10/2026
+
+@copyright Copyright (c) 2026
+
+Sends either a built-in test pattern or raw RGB frames from a file (or stdin,
+with --file -), each frame being LEDS * 3 bytes:
+
+    ddp_send.py 192.168.1.42 --leds 300 --fps 60
+    ffmpeg ... -f rawvideo -pix_fmt rgb24 - | ddp_send.py 192.168.1.42 --leds 300 --file -
+"""
+
+import argparse
+import colorsys
+import socket
+import struct
+import sys
+import time
+
+DDP_PORT = 4048
+DDP_PACKET_BYTES = 1440  # 480 pixels, fits in one Ethernet frame
+
+FLAG_VERSION_1 = 0x40
+FLAG_PUSH = 0x01
+TYPE_RGB8 = 0x0B
+ID_DISPLAY = 1
+
+
+def packets(frame, seq):
+    """Split one frame into DDP packets; the last one carries the push flag"""
+    for offset in range(0, len(frame), DDP_PACKET_BYTES):
+        data = frame[offset:offset + DDP_PACKET_BYTES]
+        push = offset + len(data) == len(frame)
+        seq = (seq % 15) + 1
+        flags = FLAG_VERSION_1 | (FLAG_PUSH if push else 0)
+        header = struct.pack(">BBBBIH", flags, seq, TYPE_RGB8, ID_DISPLAY, offset, len(data))
+        yield seq, header + data
+
+
+def test_pattern(leds):
+    """Endless rainbow chase, a frame at a time"""
+    t = 0
+    while True:
+        frame = bytearray()
+        for i in range(leds):
+            r, g, b = colorsys.hsv_to_rgb(((i / leds) + t) % 1.0, 1.0, 1.0)
+            frame += bytes((int(r * 255), int(g * 255), int(b * 255)))
+        yield bytes(frame)
+        t += 0.01
+
+
+def file_frames(stream, leds):
+    while True:
+        frame = stream.read(leds * 3)
+        if len(frame) < leds * 3:
+            return
+        yield frame
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("host", help="IP address of the light (see its state topic)")
+    parser.add_argument("--leds", type=int, default=15, help="LEDs per frame")
+    parser.add_argument("--fps", type=float, default=60, help="frames per second")
+    parser.add_argument("--file", help="raw RGB frames to send instead of the test pattern, - for stdin")
+    parser.add_argument("--port", type=int, default=DDP_PORT)
+    args = parser.parse_args()
+
+    if args.file is None:
+        frames = test_pattern(args.leds)
+    elif args.file == "-":
+        frames = file_frames(sys.stdin.buffer, args.leds)
+    else:
+        frames = file_frames(open(args.file, "rb"), args.leds)
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    period = 1.0 / args.fps
+    seq = 0
+    t_next = time.monotonic()
+
+    for frame in frames:
+        for seq, packet in packets(frame, seq):
+            sock.sendto(packet, (args.host, args.port))
+
+        # Fixed timestep, so a slow frame doesn't shift the ones after it
+        t_next += period
+        delay = t_next - time.monotonic()
+        if delay > 0:
+            time.sleep(delay)
+        else:
+            t_next = time.monotonic()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+"""
+@file embed_portal.py
+@author James Bennion-Pedley
+@brief Minify and gzip the captive portal page into a flash-resident header
+@date 17/10/2026
+
+@copyright Copyright (c) 2026
+
+Runs before every firmware build (extra_scripts in platformio.ini), turning
+firmware/src/index.html into firmware/src/portal.h: the page minified, then
+gzipped, as a PROGMEM array with an ETag taken from its contents. It only
+rewrites the header when the page has changed. Can also be run by hand:
+
+    firmware/tools/embed_portal.py
+"""
+
+import gzip
+import hashlib
+import os
+import re
+
+HEADER = """\
+// Generated from index.html by firmware/tools/embed_portal.py, don't edit
+
+#ifndef __FIRMWARE_SRC_PORTAL_H__
+#define __FIRMWARE_SRC_PORTAL_H__
+
+#include <Arduino.h>
+
+// {length} bytes from {original} (minified {minified})
+#define PORTAL_INDEX_ETAG "\\"{etag}\\""
+
+static const uint8_t m_portal_index[] PROGMEM = {{
+{data}
+}};
+
+#endif /* __FIRMWARE_SRC_PORTAL_H__ */
+"""
+
+
+def minify(html):
+    """Whitespace and comments only; the page is small and hand-written"""
+    html = re.sub(r"<!--.*?-->", "", html, flags=re.S)
+    html = re.sub(r"\s+", " ", html)
+    html = re.sub(r">\s+<", "><", html)
+
+    def css(match):
+        style = re.sub(r"\s*([{};:,])\s*", r"\1", match.group(2))
+        return match.group(1) + style.replace(";}", "}").strip() + match.group(3)
+
+    html = re.sub(r"(<style[^>]*>)(.*?)(</style>)", css, html, flags=re.S)
+    return html.strip()
+
+
+def embed(source, dest):
+    with open(source, encoding="utf-8") as f:
+        original = f.read()
+
+    minified = minify(original).encode("utf-8")
+
+    # No timestamp or name in the gzip header, so the output only changes
+    # when the page does
+    compressed = gzip.compress(minified, compresslevel=9, mtime=0)
+    etag = hashlib.sha1(compressed).hexdigest()[:16]
+
+    rows = []
+    for offset in range(0, len(compressed), 16):
+        rows.append("    " + " ".join(f"0x{b:02x}," for b in compressed[offset:offset + 16]))
+
+    header = HEADER.format(length=len(compressed), original=len(original.encode("utf-8")),
+                           minified=len(minified), etag=etag, data="\n".join(rows))
+
+    if os.path.exists(dest):
+        with open(dest, encoding="utf-8") as f:
+            if f.read() == header:
+                return
+
+    with open(dest, "w", encoding="utf-8") as f:
+        f.write(header)
+    print(f"embed_portal: {source} -> {dest}, {len(compressed)} bytes gzipped")
+
+
+try:
+    Import("env")  # noqa: F821 - defined when PlatformIO runs this
+    src_dir = env.subst("$PROJECT_SRC_DIR")  # noqa: F821
+except NameError:
+    src_dir = os.path.normpath(os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "src"))
+
+embed(os.path.join(src_dir, "index.html"), os.path.join(src_dir, "portal.h"))
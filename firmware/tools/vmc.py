@@ -0,0 +1,440 @@
+#!/usr/bin/env python3
+"""
+@file vmc.py
+@author James Bennion-Pedley
+@brief Compile pattern programs for the Custom pattern's bytecode VM
+@date 17/10/2026
+
+@copyright Copyright (c) 2026
+
+A program is a few lines of integer expressions, ending with the colour of
+each pixel (0xRRGGBB):
+
+    palette #ff0000 #0000ff         # up to 16 entries for pal()
+    let speed = beatsin8(30, 1, 8)  # named value
+    var x = t                       # per-frame starting value...
+    x = x + speed                   # ...updated pixel by pixel
+    blend(prev, pal(x + i), 64)
+
+Inputs are i (pixel index), n (pixel count), t (shared time, ms), seed, col
+(the command's colour) and prev (the pixel's colour from the last frame).
+Comments start with '# '.
+Anything that doesn't depend on i, prev or a var runs once per frame.
+Operators, loosest first: comparisons, | ^ & << >> + - * / %, unary - ! ~.
+Functions are FastLED's sin8 sin16 beat8 beatsin8 beatsin88 scale8 qadd8
+qsub8, plus min max hsv rgb pal blend, and sel(c, a, b) for c ? a : b.
+
+    vmc.py rainbow.vms                  # writes rainbow.vm
+    vmc.py rainbow.vms --list           # prints the bytecode
+    vmc.py rainbow.vms --c RAINBOW      # prints it as a C array
+    mosquitto_pub -r -t DIET-4073c85645649a02734/program/rainbow -f rainbow.vm
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+VM_VERSION = 1
+VM_MAX_CODE = 512
+VM_PALETTE_SIZE = 16
+VM_LOCALS = 16
+
+# In the same order as VM_OP_LIST in firmware/src/vm.h
+OPS = [
+    ("PUSH8", 1), ("PUSH16", 2), ("PUSH32", 4), ("LOAD", 1), ("STORE", 1),
+    ("INDEX", 0), ("LENGTH", 0), ("TIME", 0), ("SEED", 0), ("COLOUR", 0), ("PREV", 0),
+    ("ADD", 0), ("SUB", 0), ("MUL", 0), ("DIV", 0), ("MOD", 0),
+    ("AND", 0), ("OR", 0), ("XOR", 0), ("SHL", 0), ("SHR", 0),
+    ("MIN", 0), ("MAX", 0), ("LT", 0), ("EQ", 0), ("NEG", 0), ("NOT", 0),
+    ("DUP", 0), ("DROP", 0), ("SWAP", 0),
+    ("SIN8", 0), ("SIN16", 0), ("BEAT8", 0), ("BEATSIN8", 0), ("BEATSIN88", 0),
+    ("SCALE8", 0), ("QADD8", 0), ("QSUB8", 0),
+    ("HSV", 0), ("RGB", 0), ("PALETTE", 0), ("BLEND", 0),
+    ("JZ", 1), ("JMP", 1),
+]
+OPCODE = {name: i for i, (name, _) in enumerate(OPS)}
+IMMEDIATE = {name: size for name, size in OPS}
+
+INPUTS = {"i": "INDEX", "n": "LENGTH", "t": "TIME", "seed": "SEED", "col": "COLOUR", "prev": "PREV"}
+PIXEL_INPUTS = {"i", "prev"}
+
+FUNCTIONS = {
+    "sin8": ("SIN8", 1), "sin16": ("SIN16", 1), "beat8": ("BEAT8", 1),
+    "beatsin8": ("BEATSIN8", 3), "beatsin88": ("BEATSIN88", 3),
+    "scale8": ("SCALE8", 2), "qadd8": ("QADD8", 2), "qsub8": ("QSUB8", 2),
+    "min": ("MIN", 2), "max": ("MAX", 2),
+    "hsv": ("HSV", 3), "rgb": ("RGB", 3), "pal": ("PALETTE", 1), "blend": ("BLEND", 3),
+}
+
+BINARY = {
+    "+": "ADD", "-": "SUB", "*": "MUL", "/": "DIV", "%": "MOD",
+    "&": "AND", "|": "OR", "^": "XOR", "<<": "SHL", ">>": "SHR",
+}
+
+# Loosest first
+PRECEDENCE = [
+    ["<", ">", "<=", ">=", "==", "!="],
+    ["|"], ["^"], ["&"], ["<<", ">>"], ["+", "-"], ["*", "/", "%"],
+]
+
+TOKEN = re.compile(r"\s*(?:(#[0-9a-fA-F]{6})|(0x[0-9a-fA-F]+|\d+)|([A-Za-z_]\w*)|(<<|>>|<=|>=|==|!=|[-+*/%&|^<>!~(),=]))")
+
+
+class CompileError(Exception):
+    pass
+
+
+def wrap32(v):
+    v &= 0xFFFFFFFF
+    return v - (1 << 32) if v & 0x80000000 else v
+
+
+def fold(op, a, b):
+    """Constant folding, with the interpreter's wrapping arithmetic"""
+    if op in ("/", "%") and b in (0, -1):
+        return None
+    ua = a & 0xFFFFFFFF
+    quotient = abs(a) // abs(b) * (-1 if (a < 0) != (b < 0) else 1) if b else 0
+    result = {
+        "+": lambda: a + b, "-": lambda: a - b, "*": lambda: a * b,
+        "/": lambda: quotient, "%": lambda: a - quotient * b,
+        "&": lambda: a & b, "|": lambda: a | b, "^": lambda: a ^ b,
+        "<<": lambda: ua << (b & 31), ">>": lambda: ua >> (b & 31),
+    }.get(op)
+    return wrap32(result()) if result else None
+
+
+class Parser:
+    def __init__(self, text, line):
+        self.tokens = []
+        self.line = line
+        pos = 0
+        text = text.rstrip()
+        while pos < len(text):
+            m = TOKEN.match(text, pos)
+            if not m:
+                raise CompileError(f"line {line}: can't read '{text[pos:].strip()}'")
+            colour, number, name, op = m.groups()
+            if colour:
+                self.tokens.append(("num", int(colour[1:], 16)))
+            elif number:
+                self.tokens.append(("num", wrap32(int(number, 0))))
+            elif name:
+                self.tokens.append(("name", name))
+            else:
+                self.tokens.append(("op", op))
+            pos = m.end()
+        self.pos = 0
+
+    def peek(self):
+        return self.tokens[self.pos] if self.pos < len(self.tokens) else (None, None)
+
+    def take(self, value=None):
+        kind, tok = self.peek()
+        if kind is None or (value is not None and tok != value):
+            raise CompileError(f"line {self.line}: expected '{value or 'more'}'")
+        self.pos += 1
+        return kind, tok
+
+    def done(self):
+        if self.pos != len(self.tokens):
+            raise CompileError(f"line {self.line}: unexpected '{self.peek()[1]}'")
+
+    def expression(self, level=0):
+        if level == len(PRECEDENCE):
+            return self.unary()
+        node = self.expression(level + 1)
+        while self.peek()[0] == "op" and self.peek()[1] in PRECEDENCE[level]:
+            op = self.take()[1]
+            node = ("op", op, node, self.expression(level + 1))
+        return node
+
+    def unary(self):
+        kind, tok = self.peek()
+        if kind == "op" and tok in ("-", "!", "~"):
+            self.take()
+            return ("un", tok, self.unary())
+        return self.primary()
+
+    def primary(self):
+        kind, tok = self.take()
+        if kind == "num":
+            return ("num", tok)
+        if kind == "op" and tok == "(":
+            node = self.expression()
+            self.take(")")
+            return node
+        if kind == "name" and self.peek() == ("op", "("):
+            self.take("(")
+            args = []
+            if self.peek() != ("op", ")"):
+                args.append(self.expression())
+                while self.peek() == ("op", ","):
+                    self.take(",")
+                    args.append(self.expression())
+            self.take(")")
+            return ("call", tok, args)
+        if kind == "name":
+            return ("name", tok)
+        raise CompileError(f"line {self.line}: unexpected '{tok}'")
+
+
+class Compiler:
+    def __init__(self):
+        self.palette = []
+        self.locals = {}     # name -> slot
+        self.vars = set()    # names that change pixel to pixel
+        self.per_pixel = set()
+        self.prologue = []   # (name, operand) pairs
+        self.body = []
+
+    def slot(self, name, line):
+        if name in INPUTS or name in FUNCTIONS:
+            raise CompileError(f"line {line}: '{name}' is built in")
+        if name not in self.locals:
+            if len(self.locals) == VM_LOCALS:
+                raise CompileError(f"line {line}: more than {VM_LOCALS} names")
+            self.locals[name] = len(self.locals)
+        return self.locals[name]
+
+    def depends_on_pixel(self, node):
+        kind = node[0]
+        if kind == "name":
+            return node[1] in PIXEL_INPUTS or node[1] in self.per_pixel
+        if kind == "op":
+            return self.depends_on_pixel(node[2]) or self.depends_on_pixel(node[3])
+        if kind == "un":
+            return self.depends_on_pixel(node[2])
+        if kind == "call":
+            return any(self.depends_on_pixel(a) for a in node[2])
+        return False
+
+    def simplify(self, node):
+        kind = node[0]
+        if kind == "op":
+            a, b = self.simplify(node[2]), self.simplify(node[3])
+            if a[0] == "num" and b[0] == "num":
+                value = fold(node[1], a[1], b[1])
+                if value is not None:
+                    return ("num", value)
+            return ("op", node[1], a, b)
+        if kind == "un":
+            a = self.simplify(node[2])
+            if a[0] == "num":
+                return ("num", {"-": wrap32(-a[1]), "!": int(a[1] == 0), "~": wrap32(~a[1])}[node[1]])
+            return ("un", node[1], a)
+        if kind == "call":
+            return ("call", node[1], [self.simplify(a) for a in node[2]])
+        return node
+
+    def emit(self, node, out, line):
+        kind = node[0]
+        if kind == "num":
+            v = node[1]
+            if 0 <= v <= 0xFF:
+                out.append(("PUSH8", v))
+            elif -0x8000 <= v <= 0x7FFF:
+                out.append(("PUSH16", v))
+            else:
+                out.append(("PUSH32", v))
+        elif kind == "name":
+            name = node[1]
+            if name in INPUTS:
+                out.append((INPUTS[name], None))
+            elif name in self.locals:
+                out.append(("LOAD", self.locals[name]))
+            else:
+                raise CompileError(f"line {line}: '{name}' isn't defined")
+        elif kind == "op":
+            op, a, b = node[1:]
+            if op in BINARY:
+                self.emit(a, out, line)
+                self.emit(b, out, line)
+                out.append((BINARY[op], None))
+            else:
+                # Everything comes down to a < b or a == b
+                swap = op in (">", "<=")
+                self.emit(b if swap else a, out, line)
+                self.emit(a if swap else b, out, line)
+                out.append(("EQ" if op in ("==", "!=") else "LT", None))
+                if op in ("<=", ">=", "!="):
+                    out.append(("NOT", None))
+        elif kind == "un":
+            self.emit(node[2], out, line)
+            if node[1] == "~":
+                out.append(("PUSH16", -1))
+                out.append(("XOR", None))
+            else:
+                out.append(("NEG" if node[1] == "-" else "NOT", None))
+        elif kind == "call":
+            name, args = node[1:]
+            if name == "sel":
+                self.select(args, out, line)
+                return
+            if name not in FUNCTIONS:
+                raise CompileError(f"line {line}: no function '{name}'")
+            op, count = FUNCTIONS[name]
+            if len(args) != count:
+                raise CompileError(f"line {line}: {name}() takes {count} arguments")
+            for a in args:
+                self.emit(a, out, line)
+            out.append((op, None))
+
+    def select(self, args, out, line):
+        if len(args) != 3:
+            raise CompileError(f"line {line}: sel() takes 3 arguments")
+        when, then, otherwise = [], [], []
+        self.emit(args[1], then, line)
+        self.emit(args[2], otherwise, line)
+        then.append(("JMP", size(otherwise)))
+        if size(then) > 255 or size(otherwise) > 255:
+            raise CompileError(f"line {line}: sel() branch too long")
+        self.emit(args[0], out, line)
+        out.append(("JZ", size(then)))
+        out.extend(then)
+        out.extend(otherwise)
+
+    def statement(self, text, line):
+        words = text.split(None, 1)
+        if words[0] == "palette":
+            for entry in words[1].split() if len(words) > 1 else []:
+                if not re.fullmatch(r"#[0-9a-fA-F]{6}", entry):
+                    raise CompileError(f"line {line}: bad palette entry '{entry}'")
+                self.palette.append(bytes.fromhex(entry[1:]))
+            if len(self.palette) > VM_PALETTE_SIZE:
+                raise CompileError(f"line {line}: more than {VM_PALETTE_SIZE} palette entries")
+            return False
+
+        p = Parser(text, line)
+        kind, tok = p.peek()
+        if kind == "name" and tok in ("let", "var"):
+            p.take()
+            name = p.take()[1]
+            if name in self.locals:
+                raise CompileError(f"line {line}: '{name}' is already defined")
+            p.take("=")
+            expr = self.simplify(p.expression())
+            p.done()
+            if tok == "var" and self.depends_on_pixel(expr):
+                raise CompileError(f"line {line}: a var starts from per-frame values")
+            if tok == "let" and self.depends_on_pixel(expr):
+                self.per_pixel.add(name)
+                out = self.body
+            else:
+                out = self.prologue
+            if tok == "var":
+                self.vars.add(name)
+                self.per_pixel.add(name)
+            # Emitted before the slot exists, so it can't read itself
+            code = []
+            self.emit(expr, code, line)
+            out.extend(code + [("STORE", self.slot(name, line))])
+            return False
+
+        if kind == "name" and p.tokens[1:2] == [("op", "=")]:
+            p.take()
+            p.take("=")
+            if tok not in self.vars:
+                raise CompileError(f"line {line}: '{tok}' isn't a var")
+            expr = self.simplify(p.expression())
+            p.done()
+            self.emit(expr, self.body, line)
+            self.body.append(("STORE", self.locals[tok]))
+            return False
+
+        expr = self.simplify(p.expression())
+        p.done()
+        self.emit(expr, self.body, line)
+        return True
+
+    def compile(self, source):
+        finished = False
+        for line, text in enumerate(source.splitlines(), 1):
+            # Comments start with '# ', which keeps them apart from colours
+            text = re.sub(r"(^|\s)#(\s.*)?$", "", text)
+            if not text.strip():
+                continue
+            if finished:
+                raise CompileError(f"line {line}: nothing can follow the colour")
+            finished = self.statement(text.strip(), line)
+        if not finished:
+            raise CompileError("no colour at the end")
+
+        prologue, body = assemble(self.prologue), assemble(self.body)
+        if len(prologue) + len(body) > VM_MAX_CODE:
+            raise CompileError(f"{len(prologue) + len(body)} bytes of code, more than {VM_MAX_CODE}")
+
+        header = struct.pack("<2sBBHH", b"VM", VM_VERSION, len(self.palette), len(prologue), len(body))
+        return header + b"".join(self.palette) + prologue + body
+
+
+def size(code):
+    return sum(1 + IMMEDIATE[op] for op, _ in code)
+
+
+def assemble(code):
+    out = bytearray()
+    for op, operand in code:
+        out.append(OPCODE[op])
+        if IMMEDIATE[op] == 1:
+            out += struct.pack("<B", operand)
+        elif IMMEDIATE[op] == 2:
+            out += struct.pack("<h", operand)
+        elif IMMEDIATE[op] == 4:
+            out += struct.pack("<i", operand)
+    return bytes(out)
+
+
+def disassemble(code, title):
+    print(f"{title}:")
+    pc = 0
+    while pc < len(code):
+        name, imm = OPS[code[pc]]
+        operand = ""
+        if imm == 1:
+            operand = str(code[pc + 1])
+        elif imm == 2:
+            operand = str(struct.unpack_from("<h", code, pc + 1)[0])
+        elif imm == 4:
+            operand = str(struct.unpack_from("<i", code, pc + 1)[0])
+        print(f"  {pc:4}  {name:<10}{operand}")
+        pc += 1 + imm
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compile a pattern program for the Custom pattern")
+    parser.add_argument("source")
+    parser.add_argument("-o", "--output", help="image file, the source's name with .vm by default")
+    parser.add_argument("--list", action="store_true", help="print the bytecode instead")
+    parser.add_argument("--c", metavar="NAME", help="print the image as a C array instead")
+    args = parser.parse_args()
+
+    with open(args.source) as f:
+        source = f.read()
+
+    try:
+        image = Compiler().compile(source)
+    except CompileError as e:
+        sys.exit(f"{args.source}: {e}")
+
+    if args.list:
+        palette, prologue = image[3], struct.unpack_from("<H", image, 4)[0]
+        code = image[8 + palette * 3:]
+        print(f"{len(image)} bytes, {palette} palette entries")
+        disassemble(code[:prologue], "frame")
+        disassemble(code[prologue:], "pixel")
+    elif args.c:
+        print(f"// {len(image)} bytes, from {args.source} by vmc.py")
+        print(f"static const uint8_t {args.c}[] = {{")
+        for offset in range(0, len(image), 12):
+            print("    " + " ".join(f"0x{b:02x}," for b in image[offset:offset + 12]))
+        print("};")
+    else:
+        output = args.output or re.sub(r"\.\w+$", "", args.source) + ".vm"
+        with open(output, "wb") as f:
+            f.write(image)
+
+
+if __name__ == "__main__":
+    main()
@@ -12,8 +12,13 @@
 
 import * as mqtt from 'mqtt/dist/mqtt.min';
 
+// The browser has no global Buffer, and mqtt only sends Buffers as binary
+import { Buffer } from 'buffer';
+
 import { get, writable, type Writable } from 'svelte/store';
 
+import { decodeCommand, encodeCommand, isBinary, type Command } from './protocol';
+
 /*--------------------------------- Types ------------------------------------*/
 
 type SystemState = {
@@ -28,9 +33,17 @@ type SystemState = {
 
 const TOPIC_PREFIX = "DIET-4073c85645649a02734";
 
+// Lights heartbeat every 30 s; drop them after missing a few
+const DEVICE_TIMEOUT_MS = 100000;
+
 let client: mqtt.MqttClient | null = null;
 
+let sequence = 0;
+
 let devices: Writable<Set<string>> = writable(new Set([]));
+let lastSeen = new Map<string, number>();
+
+let modes: Writable<string[]> = writable(["Off", "Solid", "Fire", "Sparkle", "Calming", "Rainbow", "Stream", "Custom", "Music"]);
 
 let state: Writable<SystemState> = writable({
     mode: "Off",
@@ -42,6 +55,32 @@ let state: Writable<SystemState> = writable({
 
 /*------------------------------- Functions ----------------------------------*/
 
+function deviceSeen(mac: string) {
+    lastSeen.set(mac, Date.now());
+    if (!get(devices).has(mac)) {
+        devices.update((d) => {
+            d.add(mac);
+            return d;
+        });
+    }
+}
+
+function deviceGone(mac: string) {
+    lastSeen.delete(mac);
+    devices.update((d) => {
+        d.delete(mac);
+        return d;
+    });
+}
+
+function pruneDevices() {
+    const now = Date.now();
+    for (const [mac, t] of lastSeen) {
+        if (now - t > DEVICE_TIMEOUT_MS)
+            deviceGone(mac);
+    }
+}
+
 async function connect() {
     // Connect to broker
     if (import.meta.env.PROD) {
@@ -51,14 +90,23 @@ async function connect() {
     }
 
     // Core subtopics
-    await subscribe("discover");    // Gets light addresses + status
+    await subscribe("state/+");     // Retained light status, sent on change
+    await subscribe("heartbeat/+"); // Liveness from each light
     await subscribe("command");    // Gets commands sent by other browsers
 
     // Set up message handler
     client.on('message', function (topic, payload, packet) {
 
-        // Add discovery entries to set
-        if (topic === `${TOPIC_PREFIX}/discover`) {
+        const [, kind, mac] = topic.split("/");
+
+        // Retained state arrives straight away on subscribe, then on change
+        if (kind === "state" && mac !== undefined) {
+            // An empty payload is a light's will: it went away
+            if (payload.length === 0) {
+                deviceGone(mac);
+                return;
+            }
+
             const msg = JSON.parse(payload.toString());
 
             if (get(state).syncState === false) {
@@ -75,19 +123,26 @@ async function connect() {
                 });
             }
 
-            devices.update((d) => {
-                d.add(msg.mac);
-                return d;
-            });
-            // TODO add callback after 20 seconds to remove from list if not heard from
+            deviceSeen(mac);
+
+            // Lights advertise the patterns their firmware supports
+            if (Array.isArray(msg.modes))
+                modes.set(msg.modes);
+
+        } else if (kind === "heartbeat" && mac !== undefined) {
+            deviceSeen(mac);
 
         } else if (topic === `${TOPIC_PREFIX}/command`) {
-            const msg = JSON.parse(payload.toString());
+            const msg = isBinary(payload) ? decodeCommand(payload, get(modes)) : JSON.parse(payload.toString());
+            if (msg === null)
+                return;
 
             // TODO check if it came from me!
             state.update((s) => {
-                s.mode = msg.mode;
-                s.colour = msg.colour;
+                if (msg.mode)
+                    s.mode = msg.mode;
+                if (msg.colour)
+                    s.colour = msg.colour;
                 if (msg.enable)
                     s.enable = msg.enable;
                 if (msg.lock)
@@ -101,6 +156,8 @@ async function connect() {
 
     })
 
+    setInterval(pruneDevices, DEVICE_TIMEOUT_MS / 4);
+
     return client;
 }
 
@@ -110,6 +167,21 @@ async function publish(subtopic: string, message: string) {
     await client.publishAsync(`${TOPIC_PREFIX}/${subtopic}`, message);
 }
 
+// Commands go out as compact binary frames, which the lights parse faster than JSON.
+// Target "command" for the whole room, "command/<MAC>" or "group/<name>"
+async function sendCommand(command: Command, target = "command") {
+    if (client === null) return;
+
+    sequence = (sequence + 1) & 0xFFFF;
+    const frame = encodeCommand(command, get(modes), sequence);
+    await client.publishAsync(`${TOPIC_PREFIX}/${target}`, Buffer.from(frame));
+}
+
+// Groups are kept on the light, and replace any it had before
+async function setGroups(mac: string, groups: string[]) {
+    await publish(`command/${mac}`, JSON.stringify({ groups }));
+}
+
 async function subscribe(subtopic: string) {
     if (client === null) return;
 
@@ -118,6 +190,6 @@ async function subscribe(subtopic: string) {
 
 /*-------------------------------- Exports -----------------------------------*/
 
-export { devices, state };
+export { devices, modes, state };
 
-export default { connect, publish, subscribe };
+export default { connect, publish, sendCommand, setGroups, subscribe };
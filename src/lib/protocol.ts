@@ -0,0 +1,116 @@
+/**
+ * @file protocol.ts
+ * @author James Bennion-Pedley
+ * @brief Compact binary command frame, mirrors firmware/src/protocol.h
+ * @date 17/10/2026
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/*--------------------------------- Types ------------------------------------*/
+
+type Command = {
+    mode?: string,
+    colour?: string,
+    enable?: boolean,
+    lock?: boolean,
+    seed?: number,
+};
+
+/*--------------------------------- State ------------------------------------*/
+
+const MAGIC = 0xA5;
+const VERSION = 2;
+const FRAME_SIZE = 18;
+const FRAME_SIZE_V1 = 10;
+
+const TYPE_COMMAND = 1;
+
+const FLAG_MODE = 1 << 0;
+const FLAG_COLOUR = 1 << 1;
+const FLAG_OVERRIDE = 1 << 2;
+const FLAG_ENABLE = 1 << 3;
+const FLAG_LOCK = 1 << 4;
+const FLAG_SEED = 1 << 6;
+
+/*------------------------------- Functions ----------------------------------*/
+
+function isBinary(payload: Uint8Array): boolean {
+    return payload.length > 0 && payload[0] === MAGIC;
+}
+
+// Mode ids are the index of the mode in the list the lights advertise
+function encodeCommand(command: Command, modes: string[], seq: number): Uint8Array {
+    const frame = new Uint8Array(FRAME_SIZE);
+    let flags = 0;
+
+    const mode = command.mode === undefined ? -1 : modes.indexOf(command.mode);
+    if (mode >= 0)
+        flags |= FLAG_MODE;
+
+    if (command.colour !== undefined && /^#[0-9a-fA-F]{6}$/.test(command.colour)) {
+        flags |= FLAG_COLOUR;
+        frame[5] = parseInt(command.colour.slice(1, 3), 16);
+        frame[6] = parseInt(command.colour.slice(3, 5), 16);
+        frame[7] = parseInt(command.colour.slice(5, 7), 16);
+    }
+
+    if (command.enable !== undefined) {
+        flags |= FLAG_OVERRIDE;
+        if (command.enable)
+            flags |= FLAG_ENABLE;
+        if (command.lock)
+            flags |= FLAG_LOCK;
+    }
+
+    // Time is left to the lights' own clock; browser clocks are too far apart
+    if (command.seed !== undefined) {
+        flags |= FLAG_SEED;
+        new DataView(frame.buffer).setUint32(14, command.seed >>> 0, true);
+    }
+
+    frame[0] = MAGIC;
+    frame[1] = VERSION;
+    frame[2] = TYPE_COMMAND;
+    frame[3] = flags;
+    frame[4] = mode >= 0 ? mode : 0xFF;
+    frame[8] = seq & 0xFF;
+    frame[9] = (seq >> 8) & 0xFF;
+
+    return frame;
+}
+
+function decodeCommand(payload: Uint8Array, modes: string[]): Command | null {
+    if (payload.length < FRAME_SIZE_V1 || payload[0] !== MAGIC)
+        return null;
+    if (payload[1] < 1 || payload[1] > VERSION || (payload[1] >= 2 && payload.length < FRAME_SIZE))
+        return null;
+
+    const flags = payload[3];
+    const command: Command = {};
+
+    if (flags & FLAG_MODE && payload[4] < modes.length)
+        command.mode = modes[payload[4]];
+
+    if (flags & FLAG_COLOUR) {
+        const hex = (v: number) => v.toString(16).padStart(2, "0");
+        command.colour = `#${hex(payload[5])}${hex(payload[6])}${hex(payload[7])}`;
+    }
+
+    if (flags & FLAG_OVERRIDE) {
+        command.enable = (flags & FLAG_ENABLE) !== 0;
+        command.lock = (flags & FLAG_LOCK) !== 0;
+    }
+
+    if (payload[1] >= 2 && flags & FLAG_SEED)
+        command.seed = new DataView(payload.buffer, payload.byteOffset).getUint32(14, true);
+
+    return command;
+}
+
+/*-------------------------------- Exports -----------------------------------*/
+
+export type { Command };
+
+export { decodeCommand, encodeCommand, isBinary };